@@ -0,0 +1,105 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <vector>
+
+#include "qh_bench.h"
+#include "skyline.h"
+#include "climber_solver.h"
+
+namespace
+{
+    size_t ResidentBytes()
+    {
+        size_t pages = 0;
+        size_t resident = 0;
+        FILE* f = fopen("/proc/self/statm", "r");
+        if (!f)
+        {
+            return 0;
+        }
+        if (fscanf(f, "%zu %zu", &pages, &resident) != 2)
+        {
+            resident = 0;
+        }
+        fclose(f);
+        return resident * sysconf(_SC_PAGESIZE);
+    }
+
+    unsigned int Next(unsigned int* seed)
+    {
+        *seed = *seed * 1103515245 + 12345;
+        return *seed >> 8;
+    }
+
+    qh::Mountain RandomMountain(size_t n, unsigned int* seed)
+    {
+        qh::Mountain m;
+        m.left = static_cast<int>(Next(seed) % (4 * n));
+        m.right = m.left + 1 + Next(seed) % 64;
+        m.height = 1 + Next(seed) % 1000;
+        return m;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    for (size_t n = 1000; n <= 1000000; n *= 10)
+    {
+        unsigned int seed = 20140106;
+        std::vector<qh::Mountain> mountains(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            mountains[i] = RandomMountain(n, &seed);
+        }
+
+        // every integer edge RandomMountain() can produce is a coordinate
+        char name[64];
+        qh::ClimberSolver* solver = NULL;
+        size_t rss = ResidentBytes();
+        snprintf(name, sizeof(name), "ClimberSolver build/n=%zu", n);
+        qh::bench::Run(name, n, [&]() {
+            solver = new qh::ClimberSolver(0, static_cast<int>(4 * n + 64));
+            for (size_t i = 0; i < n; ++i)
+            {
+                solver->AddMountain(mountains[i]);
+            }
+        });
+        qh::bench::Report(name, "rss_bytes_per_mountain", static_cast<double>(ResidentBytes() - rss) / n);
+
+        // replace a random mountain by a fresh one, its edges are mostly
+        // coordinates no standing mountain uses
+        const size_t edits = 100000;
+        int64_t steps = 0;
+        snprintf(name, sizeof(name), "ClimberSolver remove+add+TotalSteps/n=%zu", n);
+        qh::bench::Run(name, edits, [&]() {
+            for (size_t e = 0; e < edits; ++e)
+            {
+                size_t victim = Next(&seed) % n;
+                qh::Mountain fresh = RandomMountain(n, &seed);
+                solver->RemoveMountain(mountains[victim]);
+                solver->AddMountain(fresh);
+                mountains[victim] = fresh;
+                steps += solver->TotalSteps();
+            }
+        });
+
+        if (solver->TotalSteps() != qh::ClimbSteps(mountains.data(), n))
+        {
+            fprintf(stderr, "%s: differs from ClimbSteps\n", name);
+            return 1;
+        }
+
+        const size_t recomputes = n >= 100000 ? 3 : 1000000 / n;
+        snprintf(name, sizeof(name), "ClimbSteps recompute per edit/n=%zu", n);
+        qh::bench::Run(name, recomputes, [&]() {
+            for (size_t r = 0; r < recomputes; ++r)
+            {
+                steps += qh::ClimbSteps(mountains.data(), n);
+            }
+        });
+        qh::bench::DoNotOptimize(steps);
+        delete solver;
+    }
+    return 0;
+}
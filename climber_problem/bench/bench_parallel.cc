@@ -0,0 +1,49 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include <thread>
+
+#include "qh_bench.h"
+#include "skyline.h"
+#include "work_stealing_pool.h"
+
+int main(int argc, char* argv[])
+{
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000000;
+    std::vector<qh::Mountain> mountains(n);
+    unsigned int seed = 20140106;
+    for (size_t i = 0; i < n; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        mountains[i].left = static_cast<int>((seed >> 4) % (4 * n));
+        seed = seed * 1103515245 + 12345;
+        mountains[i].right = mountains[i].left + 1 + (seed >> 16) % 64;
+        seed = seed * 1103515245 + 12345;
+        mountains[i].height = 1 + (seed >> 16) % 1000;
+    }
+
+    qh::Skyline serial;
+    double serial_ns = qh::bench::Run("ComputeSkyline/serial", n, [&]() {
+        qh::ComputeSkyline(mountains.data(), n, &serial);
+    });
+
+    size_t cores = std::thread::hardware_concurrency();
+    qh::bench::Report("ComputeSkylineParallel", "hardware threads", static_cast<double>(cores));
+    for (size_t threads = 1; threads <= 16; threads *= 2)
+    {
+        qh::WorkStealingPool pool(threads);
+        qh::Skyline parallel;
+        char name[64];
+        snprintf(name, sizeof(name), "ComputeSkylineParallel/threads=%zu", threads);
+        double ns = qh::bench::Run(name, n, [&]() {
+            qh::ComputeSkylineParallel(mountains.data(), n, &pool, &parallel);
+        });
+        qh::bench::Report(name, "x speedup over serial", serial_ns / ns);
+        if (!(parallel == serial))
+        {
+            fprintf(stderr, "%s: outline differs from the serial one\n", name);
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "qh_bench.h"
+#include "mountain_parser.h"
+
+namespace
+{
+    std::string Generate(size_t n, unsigned int seed)
+    {
+        std::string text;
+        char line[64];
+        snprintf(line, sizeof(line), "%zu", n);
+        text.append(line);
+        for (size_t i = 0; i < n; ++i)
+        {
+            seed = seed * 1103515245 + 12345;
+            int left = static_cast<int>((seed >> 4) % (4 * n));
+            seed = seed * 1103515245 + 12345;
+            int right = left + 1 + (seed >> 16) % 64;
+            seed = seed * 1103515245 + 12345;
+            snprintf(line, sizeof(line), "\n%d,%d,%d", left, right, 1 + (seed >> 16) % 1000);
+            text.append(line);
+        }
+        return text;
+    }
+
+    // The strtol based parser resolve() used before
+    bool ParseWithStrtol(const char* input, std::vector<qh::Mountain>* mountains)
+    {
+        char* end = NULL;
+        long count = strtol(input, &end, 10);
+        if (end == input || count < 0)
+        {
+            return false;
+        }
+        mountains->clear();
+        mountains->reserve(count);
+        const char* p = end;
+        for (long i = 0; i < count; ++i)
+        {
+            long v[3];
+            for (int j = 0; j < 3; ++j)
+            {
+                if (*p != (j == 0 ? '\n' : ','))
+                {
+                    return false;
+                }
+                ++p;
+                v[j] = strtol(p, &end, 10);
+                if (end == p)
+                {
+                    return false;
+                }
+                p = end;
+            }
+            qh::Mountain m = {static_cast<int>(v[0]), static_cast<int>(v[1]), static_cast<int>(v[2])};
+            mountains->push_back(m);
+        }
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<qh::Mountain> mountains;
+    for (size_t n = 1000; n <= 10000000; n *= 100)
+    {
+        std::string text = Generate(n, 20140106);
+        double bytes_per_mountain = static_cast<double>(text.size()) / n;
+        size_t rounds = 10000000 / n;
+        char name[64];
+
+        snprintf(name, sizeof(name), "ParseMountains/n=%zu", n);
+        double ns = qh::bench::Run(name, n * rounds, [&]() {
+            for (size_t r = 0; r < rounds; ++r)
+            {
+                if (!qh::ParseMountains(text.data(), text.size(), &mountains))
+                {
+                    abort();
+                }
+            }
+        });
+        qh::bench::Report(name, "MB/s", bytes_per_mountain * 1e3 / ns);
+
+        snprintf(name, sizeof(name), "strtol/n=%zu", n);
+        ns = qh::bench::Run(name, n * rounds, [&]() {
+            for (size_t r = 0; r < rounds; ++r)
+            {
+                if (!ParseWithStrtol(text.c_str(), &mountains))
+                {
+                    abort();
+                }
+            }
+        });
+        qh::bench::Report(name, "MB/s", bytes_per_mountain * 1e3 / ns);
+    }
+    return 0;
+}
@@ -0,0 +1,67 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "qh_bench.h"
+#include "skyline.h"
+#include "mountain_parser.h"
+
+namespace
+{
+    // Overlapping terrain: n mountains spread over 4n positions, widths up to 64
+    void Generate(size_t n, unsigned int seed, std::vector<qh::Mountain>* mountains, std::string* text)
+    {
+        mountains->resize(n);
+        text->clear();
+        char line[64];
+        snprintf(line, sizeof(line), "%zu", n);
+        text->append(line);
+        for (size_t i = 0; i < n; ++i)
+        {
+            seed = seed * 1103515245 + 12345;
+            int left = static_cast<int>((seed >> 4) % (4 * n));
+            seed = seed * 1103515245 + 12345;
+            int width = 1 + (seed >> 16) % 64;
+            seed = seed * 1103515245 + 12345;
+            int height = 1 + (seed >> 16) % 1000;
+            qh::Mountain m = {left, left + width, height};
+            (*mountains)[i] = m;
+            snprintf(line, sizeof(line), "\n%d,%d,%d", m.left, m.right, m.height);
+            text->append(line);
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<qh::Mountain> mountains;
+    std::string text;
+    for (size_t n = 10; n <= 10000000; n *= 10)
+    {
+        Generate(n, 20140106, &mountains, &text);
+        size_t rounds = n < 1000000 ? 10000000 / n : 1;
+        char name[64];
+
+        int64_t steps = 0;
+        snprintf(name, sizeof(name), "ClimbSteps/n=%zu", n);
+        qh::bench::Run(name, n * rounds, [&]() {
+            for (size_t r = 0; r < rounds; ++r)
+            {
+                steps += qh::ClimbSteps(mountains.data(), mountains.size());
+            }
+        });
+
+        snprintf(name, sizeof(name), "ParseMountains+ClimbSteps/n=%zu", n);
+        qh::bench::Run(name, n * rounds, [&]() {
+            std::vector<qh::Mountain> parsed;
+            for (size_t r = 0; r < rounds; ++r)
+            {
+                qh::ParseMountains(text.c_str(), &parsed);
+                steps += qh::ClimbSteps(parsed.data(), parsed.size());
+            }
+        });
+        qh::bench::DoNotOptimize(steps);
+    }
+    return 0;
+}
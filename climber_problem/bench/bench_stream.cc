@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <string>
+#include <vector>
+
+#include "qh_bench.h"
+#include "skyline.h"
+#include "mountain_parser.h"
+#include "stream_solver.h"
+
+namespace
+{
+    double PeakRssMB()
+    {
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_maxrss / 1024.0;
+    }
+}
+
+// Peak RSS only grows, so the budgets run from small to large and the
+// in-memory solve comes last
+int main(int argc, char* argv[])
+{
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 5000000;
+    const char* dir = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+    std::string path = std::string(dir) + "/qh_bench_stream_input.txt";
+
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f)
+    {
+        perror(path.c_str());
+        return 1;
+    }
+    fprintf(f, "%zu", n);
+    unsigned int seed = 20140106;
+    for (size_t i = 0; i < n; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        int left = static_cast<int>((seed >> 4) % (4 * n));
+        seed = seed * 1103515245 + 12345;
+        int right = left + 1 + (seed >> 16) % 64;
+        seed = seed * 1103515245 + 12345;
+        fprintf(f, "\n%d,%d,%d", left, right, 1 + (seed >> 16) % 1000);
+    }
+    double mb = ftell(f) / 1e6;
+    fclose(f);
+    qh::bench::Report("input", "mountains", static_cast<double>(n));
+    qh::bench::Report("input", "MB", mb);
+    qh::bench::Report("input", "MB peak RSS before solving", PeakRssMB());
+
+    const size_t budgets[] = {1 << 20, 16 << 20, 256 << 20};
+    int64_t streamed = 0;
+    for (size_t i = 0; i < sizeof(budgets) / sizeof(budgets[0]); ++i)
+    {
+        qh::StreamOptions options;
+        options.memory_budget = budgets[i];
+        char name[64];
+        snprintf(name, sizeof(name), "StreamClimbSteps/budget=%zuMB", budgets[i] >> 20);
+        double ns = qh::bench::Run(name, n, [&]() {
+            qh::ParseError error;
+            if (!qh::StreamClimbSteps(path.c_str(), options, &streamed, &error))
+            {
+                fprintf(stderr, "%s at %zu\n", error.reason, error.offset);
+                exit(1);
+            }
+        });
+        qh::bench::Report(name, "MB/s", mb * 1e9 / (ns * n));
+        qh::bench::Report(name, "MB peak RSS so far", PeakRssMB());
+    }
+
+    int64_t in_memory = 0;
+    double ns = qh::bench::Run("read+ParseMountains+ClimbSteps", n, [&]() {
+        FILE* in = fopen(path.c_str(), "rb");
+        std::string text;
+        char block[1 << 16];
+        size_t len;
+        while ((len = fread(block, 1, sizeof(block), in)) > 0)
+        {
+            text.append(block, len);
+        }
+        fclose(in);
+        std::vector<qh::Mountain> mountains;
+        qh::ParseMountains(text.data(), text.size(), &mountains);
+        in_memory = qh::ClimbSteps(mountains.data(), mountains.size());
+    });
+    qh::bench::Report("read+ParseMountains+ClimbSteps", "MB/s", mb * 1e9 / (ns * n));
+    qh::bench::Report("read+ParseMountains+ClimbSteps", "MB peak RSS", PeakRssMB());
+
+    remove(path.c_str());
+    if (streamed != in_memory)
+    {
+        fprintf(stderr, "streamed %lld != in memory %lld\n", (long long)streamed, (long long)in_memory);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,224 @@
+#include "climber_solver.h"
+
+#include <assert.h>
+#include <algorithm>
+
+namespace qh
+{
+    ClimberSolver::ClimberSolver(int min_x, int max_x)
+        : dense_(true), dense_min_(min_x), leaves_(0)
+    {
+        Init(max_x > min_x ? static_cast<size_t>(static_cast<int64_t>(max_x) - min_x) : 0);
+    }
+
+    ClimberSolver::ClimberSolver(const std::vector<int>& coordinates)
+        : dense_(false), dense_min_(0), xs_(coordinates), leaves_(0)
+    {
+        std::sort(xs_.begin(), xs_.end());
+        xs_.erase(std::unique(xs_.begin(), xs_.end()), xs_.end());
+        Init(xs_.empty() ? 0 : xs_.size() - 1);
+    }
+
+    ClimberSolver::ClimberSolver(const Mountain* mountains, size_t n, const std::vector<int>& coordinates)
+        : dense_(false), dense_min_(0), xs_(coordinates), leaves_(0)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            xs_.push_back(mountains[i].left);
+            xs_.push_back(mountains[i].right);
+        }
+        std::sort(xs_.begin(), xs_.end());
+        xs_.erase(std::unique(xs_.begin(), xs_.end()), xs_.end());
+        Init(xs_.empty() ? 0 : xs_.size() - 1);
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            AddMountain(mountains[i]);
+        }
+    }
+
+    bool ClimberSolver::AddMountain(const Mountain& m)
+    {
+        if (m.left >= m.right || m.height <= 0 || !HasCoordinate(m.left) || !HasCoordinate(m.right))
+        {
+            return false;
+        }
+        mountains_.insert(m);
+        Update(0, 0, leaves_, LeafOf(m.left), LeafOf(m.right), m.height, true);
+        return true;
+    }
+
+    bool ClimberSolver::RemoveMountain(const Mountain& m)
+    {
+        std::multiset<Mountain, RightFirst>::iterator it = mountains_.find(m);
+        if (it == mountains_.end())
+        {
+            return false;
+        }
+        mountains_.erase(it);
+        Update(0, 0, leaves_, LeafOf(m.left), LeafOf(m.right), m.height, false);
+        return true;
+    }
+
+    int64_t ClimberSolver::TotalSteps() const
+    {
+        if (mountains_.empty())
+        {
+            return 0;
+        }
+
+        // walk on from height 0 before the first leaf and back down to 0 after the last
+        const Summary& root = nodes_[0].summary;
+        return static_cast<int64_t>(mountains_.rbegin()->right) + root.left + root.variation + root.right;
+    }
+
+    bool ClimberSolver::HasCoordinate(int x) const
+    {
+        if (dense_)
+        {
+            return leaves_ > 0 && x >= dense_min_ && static_cast<int64_t>(x) - dense_min_ <= static_cast<int64_t>(leaves_);
+        }
+        return std::binary_search(xs_.begin(), xs_.end(), x);
+    }
+
+    ClimberSolver::Summary ClimberSolver::Flat(int height)
+    {
+        Summary s = {height, height, height, height, 0};
+        return s;
+    }
+
+    ClimberSolver::Summary ClimberSolver::Combine(const Summary& a, const Summary& b)
+    {
+        int64_t step = static_cast<int64_t>(a.right) - b.left;
+        Summary s;
+        s.left = a.left;
+        s.right = b.right;
+        s.low = std::min(a.low, b.low);
+        s.high = std::max(a.high, b.high);
+        s.variation = a.variation + b.variation + (step < 0 ? -step : step);
+        return s;
+    }
+
+    void ClimberSolver::Init(size_t leaves)
+    {
+        leaves_ = leaves;
+        assert(leaves < (static_cast<size_t>(1) << 31));
+        Node empty = {Flat(0), 0, 0};
+        nodes_.assign(leaves ? 2 * leaves - 1 : 0, empty);
+    }
+
+    // the leaf that starts at coordinate x, x must be one
+    size_t ClimberSolver::LeafOf(int x) const
+    {
+        if (dense_)
+        {
+            return static_cast<size_t>(static_cast<int64_t>(x) - dense_min_);
+        }
+        return std::lower_bound(xs_.begin(), xs_.end(), x) - xs_.begin();
+    }
+
+    // [lo, hi) are the leaves under node, [first, last) the leaves the mountain covers
+    void ClimberSolver::Update(size_t node, size_t lo, size_t hi, size_t first, size_t last, int height, bool add)
+    {
+        if (first <= lo && hi <= last)
+        {
+            ChangeCover(node, height, add);
+            Pull(node, lo, hi);
+            return;
+        }
+
+        size_t mid = lo + (hi - lo) / 2;
+        if (first < mid)
+        {
+            Update(node + 1, lo, mid, first, last, height, add);
+        }
+        if (mid < last)
+        {
+            Update(node + 2 * (mid - lo), mid, hi, first, last, height, add);
+        }
+        Pull(node, lo, hi);
+    }
+
+    void ClimberSolver::ChangeCover(size_t node, int height, bool add)
+    {
+        Node& n = nodes_[node];
+        uint64_t base = static_cast<uint64_t>(node) << 32;
+        if (add)
+        {
+            if (height == n.cover)
+            {
+                ++n.cover_count;
+                return;
+            }
+            if (height < n.cover)
+            {
+                ++lower_covers_[base | static_cast<uint32_t>(height)];
+                return;
+            }
+            if (n.cover_count)
+            {
+                lower_covers_[base | static_cast<uint32_t>(n.cover)] = n.cover_count;
+            }
+            n.cover = height;
+            n.cover_count = 1;
+            return;
+        }
+
+        if (height != n.cover)
+        {
+            std::map<uint64_t, uint32_t>::iterator it = lower_covers_.find(base | static_cast<uint32_t>(height));
+            assert(it != lower_covers_.end());
+            if (--it->second == 0)
+            {
+                lower_covers_.erase(it);
+            }
+            return;
+        }
+        if (--n.cover_count)
+        {
+            return;
+        }
+
+        // the next highest is the last key below the next node's keys
+        n.cover = 0;
+        std::map<uint64_t, uint32_t>::iterator it = lower_covers_.lower_bound(base + (static_cast<uint64_t>(1) << 32));
+        if (it != lower_covers_.begin() && ((--it)->first >> 32) == node)
+        {
+            n.cover = static_cast<int>(it->first & 0xffffffffu);
+            n.cover_count = it->second;
+            lower_covers_.erase(it);
+        }
+    }
+
+    void ClimberSolver::Pull(size_t node, size_t lo, size_t hi)
+    {
+        int cover = nodes_[node].cover;
+        if (hi - lo == 1)
+        {
+            nodes_[node].summary = Flat(cover);
+            return;
+        }
+
+        size_t mid = lo + (hi - lo) / 2;
+        nodes_[node].summary = Combine(Eval(node + 1, lo, mid, cover), Eval(node + 2 * (mid - lo), mid, hi, cover));
+    }
+
+    // The summary of node's leaves once every leaf is raised to at least floor
+    ClimberSolver::Summary ClimberSolver::Eval(size_t node, size_t lo, size_t hi, int floor) const
+    {
+        const Summary& s = nodes_[node].summary;
+        if (floor <= s.low)
+        {
+            return s;
+        }
+        if (floor >= s.high)
+        {
+            return Flat(floor);
+        }
+
+        // the node's own cover is at most s.low, so floor dominates it
+        assert(hi - lo > 1);
+        size_t mid = lo + (hi - lo) / 2;
+        return Combine(Eval(node + 1, lo, mid, floor), Eval(node + 2 * (mid - lo), mid, hi, floor));
+    }
+}
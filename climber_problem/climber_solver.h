@@ -0,0 +1,129 @@
+#ifndef QIHOO_CLIMBER_SOLVER_H_
+#define QIHOO_CLIMBER_SOLVER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "skyline.h"
+
+namespace qh
+{
+    /**
+    * Keeps the answer of the climber problem up to date while mountains are
+    * added and removed one at a time.
+    *
+    * The x coordinates mountains may use are fixed when the solver is made,
+    * either as a dense range or as a list, and the elementary intervals
+    * between them are the leaves of a segment tree. A mountain is put on the
+    * O(log n) nodes that exactly cover its range. Every node keeps the height
+    * of the highest mountain on it and how many have that height. The lower
+    * heights, which most nodes do not have, live in one ordered map keyed by
+    * node, so a removal finds the next highest in O(log n). The height of a
+    * leaf is the highest mountain on its way to the root. Every node caches,
+    * for its range, the heights of its two ends, the lowest and highest
+    * height and the sum of the height changes inside it. An edit only
+    * refreshes the nodes on the paths to the covering nodes and TotalSteps()
+    * reads the root.
+    *
+    * Refreshing a node has to raise its children to the node's highest
+    * mountain. A child entirely above or below that height is taken as a
+    * whole, only children that straddle it are descended into. So an edit
+    * costs O(log n) refreshes of O(log n) each when the mountains nest or sit
+    * side by side, but one whose height cuts through k pieces of the outline
+    * below it pays O(k) more. That is the honest bound; plain O(log n) would
+    * need max-assign without removal.
+    *
+    * A mountain with an edge that is not one of the coordinates is refused,
+    * finding that out costs O(log n).
+    */
+    class ClimberSolver
+    {
+    public:
+        //! \brief No mountains yet, every integer in [min_x, max_x] may be an edge
+        ClimberSolver(int min_x, int max_x);
+
+        //! \brief No mountains yet, the given coordinates may be edges
+        explicit ClimberSolver(const std::vector<int>& coordinates);
+
+        //! \brief Start with the given mountains already added. Their edges and
+        //!   the given coordinates may be the edges of later mountains.
+        ClimberSolver(const Mountain* mountains, size_t n, const std::vector<int>& coordinates = std::vector<int>());
+
+        //! \brief Mountains with left >= right or height <= 0 are ignored, like ComputeSkyline() does
+        //! \return - bool - false if m was ignored or has an edge that is not a coordinate
+        bool AddMountain(const Mountain& m);
+
+        //! \brief Remove one mountain equal to m
+        //! \return - bool - false if no such mountain was added
+        bool RemoveMountain(const Mountain& m);
+
+        //! \brief The same as ClimbSteps() on the current mountains. O(1).
+        int64_t TotalSteps() const;
+
+        //! \brief Number of mountains currently standing
+        size_t size() const { return mountains_.size(); }
+
+        //! \brief Whether x may be an edge of a mountain
+        bool HasCoordinate(int x) const;
+
+    private:
+        //! What a range of leaves looks like
+        struct Summary
+        {
+            int     left;       //! height of the first leaf
+            int     right;      //! height of the last leaf
+            int     low;
+            int     high;
+            int64_t variation;  //! sum of |height change| between neighbouring leaves
+        };
+
+        struct Node
+        {
+            Summary     summary;
+            int         cover;          //! the highest mountain on this node, 0 if none
+            uint32_t    cover_count;    //! mountains of that height on this node
+        };
+
+        struct RightFirst
+        {
+            bool operator()(const Mountain& a, const Mountain& b) const
+            {
+                if (a.right != b.right)
+                {
+                    return a.right < b.right;
+                }
+                if (a.left != b.left)
+                {
+                    return a.left < b.left;
+                }
+                return a.height < b.height;
+            }
+        };
+
+        static Summary Flat(int height);
+        static Summary Combine(const Summary& a, const Summary& b);
+
+        void Init(size_t leaves);
+        size_t LeafOf(int x) const;
+        void Update(size_t node, size_t lo, size_t hi, size_t first, size_t last, int height, bool add);
+        void ChangeCover(size_t node, int height, bool add);
+        void Pull(size_t node, size_t lo, size_t hi);
+        Summary Eval(size_t node, size_t lo, size_t hi, int floor) const;
+
+    private:
+        // either every integer from dense_min_ on, or the sorted distinct xs_
+        bool                                dense_;
+        int                                 dense_min_;
+        std::vector<int>                    xs_;
+        size_t                              leaves_;
+        // preorder: the children of node over [lo, hi) are node + 1 and node + 2 * (mid - lo)
+        std::vector<Node>                   nodes_;
+        std::map<uint64_t, uint32_t>        lower_covers_;  // node << 32 | height to count, below the node's cover
+        std::multiset<Mountain, RightFirst> mountains_; // the last one has the right-most edge
+    };
+}
+
+#endif //QIHOO_CLIMBER_SOLVER_H_
@@ -1,5 +1,15 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <assert.h>
+#include <string>
+#include <vector>
+
+#include "skyline.h"
+#include "mountain_parser.h"
+#include "climber_solver.h"
+#include "stream_solver.h"
+#include "work_stealing_pool.h"
 
 #define H_ARRAYSIZE(a) \
     ((sizeof(a) / sizeof(*(a))) / \
@@ -7,7 +17,358 @@
 
 int resolve(const char* input)
 {
-    return 0;
+    std::vector<qh::Mountain> mountains;
+    if (!qh::ParseMountains(input, &mountains))
+    {
+        return -1;
+    }
+    return static_cast<int>(qh::ClimbSteps(mountains.data(), mountains.size()));
+}
+
+// The per-unit-x definition of the problem, only usable on tiny coordinates
+long long BruteForceSteps(const std::vector<qh::Mountain>& mountains)
+{
+    int end = 0;
+    for (size_t i = 0; i < mountains.size(); ++i)
+    {
+        if (mountains[i].left < mountains[i].right && mountains[i].height > 0 && mountains[i].right > end)
+        {
+            end = mountains[i].right;
+        }
+    }
+
+    long long steps = end;
+    int previous = 0;
+    for (int x = 0; x <= end; ++x)
+    {
+        int h = 0;
+        for (size_t i = 0; i < mountains.size(); ++i)
+        {
+            if (mountains[i].left <= x && x < mountains[i].right && mountains[i].height > h)
+            {
+                h = mountains[i].height;
+            }
+        }
+        steps += h > previous ? h - previous : previous - h;
+        previous = h;
+    }
+    return steps;
+}
+
+void test_skyline()
+{
+    const qh::Mountain mountains[] = {{1, 3, 2}, {2, 4, 4}, {6, 7, 5}};
+    qh::Skyline skyline;
+    qh::ComputeSkyline(mountains, H_ARRAYSIZE(mountains), &skyline);
+    const qh::SkylinePoint expected[] = {{1, 2}, {2, 4}, {4, 0}, {6, 5}, {7, 0}};
+    assert(skyline.size() == H_ARRAYSIZE(expected));
+    for (size_t i = 0; i < skyline.size(); ++i)
+    {
+        assert(skyline[i] == expected[i]);
+    }
+    assert(qh::CountSteps(skyline) == 25);
+
+    // touching and nested mountains of the same height melt into one
+    const qh::Mountain flat[] = {{0, 2, 3}, {2, 5, 3}, {1, 4, 3}, {3, 4, 1}};
+    qh::ComputeSkyline(flat, H_ARRAYSIZE(flat), &skyline);
+    assert(skyline.size() == 2);
+    assert(skyline[0].x == 0 && skyline[0].height == 3);
+    assert(skyline[1].x == 5 && skyline[1].height == 0);
+
+    // degenerate mountains are ignored
+    const qh::Mountain degenerate[] = {{3, 3, 5}, {4, 2, 5}, {1, 2, 0}};
+    qh::ComputeSkyline(degenerate, H_ARRAYSIZE(degenerate), &skyline);
+    assert(skyline.empty());
+    assert(qh::CountSteps(skyline) == 0);
+    assert(qh::ClimbSteps(NULL, 0) == 0);
+}
+
+void test_random_against_brute_force()
+{
+    srand(20140106);
+    for (int round = 0; round < 2000; ++round)
+    {
+        std::vector<qh::Mountain> mountains(rand() % 12);
+        for (size_t i = 0; i < mountains.size(); ++i)
+        {
+            mountains[i].left = rand() % 30;
+            mountains[i].right = mountains[i].left + 1 + rand() % 10;
+            mountains[i].height = 1 + rand() % 8;
+        }
+        assert(qh::ClimbSteps(mountains.data(), mountains.size()) == BruteForceSteps(mountains));
+    }
+}
+
+void test_parse()
+{
+    std::vector<qh::Mountain> mountains;
+    assert(qh::ParseMountains("2\n1,2,3\n4,5,6\n", &mountains));
+    assert(mountains.size() == 2);
+    assert(mountains[1].left == 4 && mountains[1].right == 5 && mountains[1].height == 6);
+
+    assert(qh::ParseMountains("0\n", &mountains));
+    assert(mountains.empty());
+
+    assert(!qh::ParseMountains("", &mountains));
+    assert(!qh::ParseMountains("2\n1,2,3\n", &mountains));
+    assert(!qh::ParseMountains("1\n1,2\n", &mountains));
+    assert(!qh::ParseMountains("1\n1;2;3\n", &mountains));
+    assert(resolve("1\n1,x,3") == -1);
+
+    // line endings, signs and trailing white space
+    assert(qh::ParseMountains("2\r\n-1,2,3\r\n4,5,-6\r\n \n", &mountains));
+    assert(mountains.size() == 2);
+    assert(mountains[0].left == -1 && mountains[1].height == -6);
+    assert(qh::ParseMountains("1\n2147483647,-2147483648,0", &mountains));
+    assert(mountains[0].left == 2147483647 && mountains[0].right == -2147483647 - 1);
+
+    // an explicit length, no NUL needed
+    const char text[] = {'1', '\n', '1', ',', '2', ',', '3', '9'};
+    assert(qh::ParseMountains(text, sizeof(text) - 1, &mountains));
+    assert(mountains.size() == 1 && mountains[0].height == 3);
+
+    // errors point at the offending byte
+    struct
+    {
+        const char* input;
+        size_t      offset;
+    } bad[] = {
+        {"", 0},
+        {"x", 0},
+        {"3\n1,2,3", 0},                       // count larger than the input can hold
+        {"99999999999999999999\n", 0},
+        {"2\n1,2,3\n4,5,6   \n7,8,9", 17},
+        {"2\n1,2,3 4,5,6\n", 7},
+        {"1\n1;2;3\n", 3},
+        {"1\n1,,3\n", 4},
+        {"1\n1,2,-\n", 6},
+        {"1\n1,2,2147483648\n", 6},
+        {"1\n1,2,33333333333\n", 6},
+        {"1\n1,2,3\nx", 8},
+        {"1\n1,2,3,4", 7},
+        };
+    for (size_t i = 0; i < H_ARRAYSIZE(bad); ++i)
+    {
+        qh::ParseError error = {0, NULL};
+        mountains.resize(1);
+        assert(!qh::ParseMountains(bad[i].input, &mountains, &error));
+        assert(mountains.empty());
+        assert(error.offset == bad[i].offset);
+        assert(error.reason != NULL);
+    }
+}
+
+// Every split of the input down to single mountains has to give the serial outline
+void check_parallel(const std::vector<qh::Mountain>& mountains, size_t grain)
+{
+    qh::Skyline serial;
+    qh::ComputeSkyline(mountains.data(), mountains.size(), &serial);
+    for (size_t threads = 1; threads <= 4; ++threads)
+    {
+        qh::WorkStealingPool pool(threads);
+        qh::Skyline parallel;
+        qh::ComputeSkylineParallel(mountains.data(), mountains.size(), &pool, &parallel, grain);
+        assert(parallel == serial);
+    }
+}
+
+void test_merge()
+{
+    const qh::Mountain left[] = {{1, 3, 2}, {6, 7, 5}};
+    const qh::Mountain right[] = {{2, 4, 4}, {0, 1, 2}};
+    qh::Skyline a, b, merged;
+    qh::ComputeSkyline(left, H_ARRAYSIZE(left), &a);
+    qh::ComputeSkyline(right, H_ARRAYSIZE(right), &b);
+    qh::MergeSkylines(a, b, &merged);
+    const qh::SkylinePoint expected[] = {{0, 2}, {2, 4}, {4, 0}, {6, 5}, {7, 0}};
+    assert(merged.size() == H_ARRAYSIZE(expected));
+    for (size_t i = 0; i < merged.size(); ++i)
+    {
+        assert(merged[i] == expected[i]);
+    }
+
+    qh::MergeSkylines(a, qh::Skyline(), &merged);
+    assert(merged == a);
+}
+
+void test_parallel_random()
+{
+    srand(20140107);
+    for (int round = 0; round < 200; ++round)
+    {
+        std::vector<qh::Mountain> mountains(rand() % 64);
+        for (size_t i = 0; i < mountains.size(); ++i)
+        {
+            mountains[i].left = rand() % 100;
+            mountains[i].right = mountains[i].left + rand() % 20;
+            mountains[i].height = rand() % 10;
+        }
+        check_parallel(mountains, 1 + rand() % 8);
+    }
+
+    std::vector<qh::Mountain> big(100000);
+    for (size_t i = 0; i < big.size(); ++i)
+    {
+        big[i].left = rand() % 1000000;
+        big[i].right = big[i].left + 1 + rand() % 1000;
+        big[i].height = 1 + rand() % 100000;
+    }
+    check_parallel(big, 1000);
+    assert(qh::ClimbStepsParallel(big.data(), big.size(), 4) == qh::ClimbSteps(big.data(), big.size()));
+}
+
+// Add the mountains one by one, then take them away again in another order
+void check_incremental(const std::vector<qh::Mountain>& mountains)
+{
+    std::vector<int> edges;
+    for (size_t i = 0; i < mountains.size(); ++i)
+    {
+        edges.push_back(mountains[i].left);
+        edges.push_back(mountains[i].right);
+    }
+    qh::ClimberSolver solver(edges);
+    for (size_t i = 0; i < mountains.size(); ++i)
+    {
+        bool valid = mountains[i].left < mountains[i].right && mountains[i].height > 0;
+        assert(solver.AddMountain(mountains[i]) == valid);
+        assert(solver.TotalSteps() == qh::ClimbSteps(mountains.data(), i + 1));
+    }
+
+    qh::ClimberSolver built(mountains.data(), mountains.size());
+    assert(built.TotalSteps() == solver.TotalSteps());
+    assert(built.size() == solver.size());
+
+    for (size_t i = 0; i < mountains.size(); ++i)
+    {
+        bool valid = mountains[i].left < mountains[i].right && mountains[i].height > 0;
+        assert(solver.RemoveMountain(mountains[i]) == valid);
+        assert(solver.TotalSteps() == qh::ClimbSteps(mountains.data() + i + 1, mountains.size() - i - 1));
+    }
+    assert(solver.size() == 0);
+    assert(solver.TotalSteps() == 0);
+}
+
+void test_incremental()
+{
+    qh::ClimberSolver solver(0, 10);
+    assert(solver.TotalSteps() == 0);
+    const qh::Mountain m = {1, 3, 2};
+    assert(!solver.RemoveMountain(m));
+    assert(solver.AddMountain(m));
+    assert(solver.AddMountain(m));
+    assert(solver.TotalSteps() == 7);
+
+    // edges outside the coordinates are refused and change nothing
+    const qh::Mountain outside = {5, 11, 4};
+    assert(!solver.AddMountain(outside) && !solver.RemoveMountain(outside));
+    assert(solver.size() == 2 && solver.TotalSteps() == 7);
+    assert(solver.HasCoordinate(0) && solver.HasCoordinate(10) && !solver.HasCoordinate(-1) && !solver.HasCoordinate(11));
+    qh::ClimberSolver listed(std::vector<int>(1, 3));
+    assert(listed.HasCoordinate(3) && !listed.AddMountain(m) && listed.TotalSteps() == 0);
+    std::vector<int> xs;
+    xs.push_back(3);
+    xs.push_back(1);
+    xs.push_back(8);
+    qh::ClimberSolver sparse(xs);
+    assert(sparse.AddMountain(m) && !sparse.HasCoordinate(2));
+    const qh::Mountain wide = {1, 8, 1};
+    assert(sparse.AddMountain(wide) && sparse.TotalSteps() == 8 + 2 + 1 + 1);
+
+    assert(solver.RemoveMountain(m));
+    assert(solver.TotalSteps() == 7);
+    assert(solver.RemoveMountain(m));
+    assert(!solver.RemoveMountain(m));
+    assert(solver.TotalSteps() == 0);
+
+    // random edits against a full recomputation
+    srand(20140108);
+    for (int round = 0; round < 300; ++round)
+    {
+        std::vector<qh::Mountain> standing;
+        qh::ClimberSolver random(-5, 50);
+        for (int edit = 0; edit < 40; ++edit)
+        {
+            if (!standing.empty() && rand() % 3 == 0)
+            {
+                size_t victim = rand() % standing.size();
+                assert(random.RemoveMountain(standing[victim]));
+                standing.erase(standing.begin() + victim);
+            }
+            else
+            {
+                qh::Mountain added;
+                added.left = rand() % 40 - 5;
+                added.right = added.left + 1 + rand() % 12;
+                added.height = 1 + rand() % 10;
+                assert(random.AddMountain(added));
+                standing.push_back(added);
+            }
+            assert(random.TotalSteps() == qh::ClimbSteps(standing.data(), standing.size()));
+        }
+        check_incremental(standing);
+    }
+}
+
+// Solve text through a temporary file with the given budget
+bool stream_steps(const std::string& text, size_t budget, int64_t* steps, qh::ParseError* error = NULL)
+{
+    FILE* f = tmpfile();
+    assert(f);
+    fwrite(text.data(), 1, text.size(), f);
+    rewind(f);
+    qh::StreamOptions options;
+    options.memory_budget = budget;
+    bool ok = qh::StreamClimbSteps(f, options, steps, error);
+    fclose(f);
+    return ok;
+}
+
+void test_stream()
+{
+    // enough events for dozens of runs and more than one merge pass at the smallest budget
+    srand(20140109);
+    std::vector<qh::Mountain> mountains(20000);
+    std::string text = "20000";
+    for (size_t i = 0; i < mountains.size(); ++i)
+    {
+        mountains[i].left = rand() % 100000 - 100;
+        mountains[i].right = mountains[i].left + rand() % 500;
+        mountains[i].height = rand() % 1000;
+        char line[64];
+        snprintf(line, sizeof(line), "%s%d,%d,%d", i % 2 ? "\r\n" : "\n",
+            mountains[i].left, mountains[i].right, mountains[i].height);
+        text += line;
+    }
+    text += "\n\n";
+    int64_t expected = qh::ClimbSteps(mountains.data(), mountains.size());
+    const size_t budgets[] = {0, 16 << 10, 64 << 10, 1 << 20, 64 << 20};
+    for (size_t i = 0; i < H_ARRAYSIZE(budgets); ++i)
+    {
+        int64_t steps = -1;
+        assert(stream_steps(text, budgets[i], &steps));
+        assert(steps == expected);
+    }
+
+    // errors carry the same offsets as the in-memory parser
+    const char* bad[] = {"", "x", "2\n1,2,3 4,5,6\n", "1\n1;2;3\n", "1\n1,,3\n",
+        "1\n1,2,2147483648\n", "1\n1,2,3\nx", "1\n1,2,3,4"};
+    for (size_t i = 0; i < H_ARRAYSIZE(bad); ++i)
+    {
+        std::vector<qh::Mountain> parsed;
+        qh::ParseError expected_error = {0, NULL};
+        qh::ParseError error = {0, NULL};
+        int64_t steps = 0;
+        assert(!qh::ParseMountains(bad[i], &parsed, &expected_error));
+        assert(!stream_steps(bad[i], 0, &steps, &error));
+        assert(error.offset == expected_error.offset);
+        assert(strcmp(error.reason, expected_error.reason) == 0);
+    }
+
+    int64_t steps = 0;
+    qh::ParseError error = {0, NULL};
+    assert(!stream_steps("3\n1,2,3\n", 0, &steps, &error));
+    assert(error.offset == 8);
+    assert(!qh::StreamClimbSteps("/nonexistent/climber.txt", qh::StreamOptions(), &steps, &error));
 }
 
 int main(int argc, char* argv[]) 
@@ -24,12 +385,36 @@ int main(int argc, char* argv[])
         "3\n0,1,1\n2,4,3\n3,5,1",
         "4\n0,1,1\n2,4,3\n3,5,1\n5,6,1",
         "5\n0,1,1\n2,4,3\n3,5,1\n5,6,1\n6,8,3",
-        //TODO please add more test case here
+        "0\n",
+        "2\n0,10,5\n2,4,3",        // hidden behind a higher one
+        "2\n0,4,3\n4,8,3",         // same height, touching
+        "2\n1,5,2\n3,4,6",         // a peak on top
+        "3\n5,6,1\n1,2,1\n3,4,1",  // unsorted input
         };
-    int expectedSteps[] = {25, 4, 7, 10, 14, 15, 3, 12, 13, 14, 20};
+    int expectedSteps[] = {25, 4, 7, 10, 14, 15, 3, 12, 13, 14, 20, 0, 20, 14, 17, 12};
+    assert(H_ARRAYSIZE(input) == H_ARRAYSIZE(expectedSteps));
     for (size_t i = 0; i < H_ARRAYSIZE(input); ++i)
     {
         assert(resolve(input[i]) == expectedSteps[i]);
+
+        std::vector<qh::Mountain> mountains;
+        assert(qh::ParseMountains(input[i], &mountains));
+        check_parallel(mountains, 1);
+        check_incremental(mountains);
+
+        int64_t streamed = -1;
+        assert(stream_steps(input[i], 0, &streamed));
+        assert(streamed == expectedSteps[i]);
+        assert(qh::ClimberSolver(mountains.data(), mountains.size()).TotalSteps() == expectedSteps[i]);
+        assert(qh::ClimbStepsParallel(mountains.data(), mountains.size(), 4) == expectedSteps[i]);
     }
+
+    test_skyline();
+    test_random_against_brute_force();
+    test_parse();
+    test_merge();
+    test_parallel_random();
+    test_incremental();
+    test_stream();
     return 0;
 }
@@ -0,0 +1,172 @@
+#include "mountain_parser.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+
+namespace qh
+{
+    namespace
+    {
+        // The shortest mountain line is "\n0,0,0"
+        const size_t kMinLineLength = 6;
+
+        // Leaves *p on the first byte that is not a digit
+        inline uint64_t ParseDigits(const char** p, const char* end, int* digits)
+        {
+            const char* s = *p;
+            uint64_t value = 0;
+            for (; s != end; ++s)
+            {
+                unsigned int d = static_cast<unsigned char>(*s) - '0';
+                if (d > 9)
+                {
+                    break;
+                }
+                // 19 digits always fit, longer numbers are rejected by the caller
+                if (s - *p < 19)
+                {
+                    value = value * 10 + d;
+                }
+            }
+            *digits = static_cast<int>(s - *p);
+            *p = s;
+            return value;
+        }
+
+        //! \return - const char * - NULL on success, else why, with *p left on the number
+        inline const char* ParseInt(const char** p, const char* end, int* value)
+        {
+            const char* start = *p;
+            bool negative = *p != end && **p == '-';
+            if (negative)
+            {
+                ++*p;
+            }
+
+            int digits = 0;
+            uint64_t v = ParseDigits(p, end, &digits);
+            uint64_t limit = negative ? static_cast<uint64_t>(INT_MAX) + 1 : INT_MAX;
+            if (digits == 0)
+            {
+                *p = start;
+                return "expected a number";
+            }
+            if (digits > 10 || v > limit)
+            {
+                *p = start;
+                return "number out of range";
+            }
+            *value = negative ? static_cast<int>(-static_cast<int64_t>(v)) : static_cast<int>(v);
+            return NULL;
+        }
+
+        inline bool IsSpace(char c)
+        {
+            return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+        }
+
+        bool Fail(const char* input, const char* at, const char* reason,
+            std::vector<Mountain>* mountains, ParseError* error)
+        {
+            mountains->clear();
+            if (error)
+            {
+                error->offset = static_cast<size_t>(at - input);
+                error->reason = reason;
+            }
+            return false;
+        }
+    }
+
+    const char* ParseMountainCount(const char** p, const char* end, uint64_t* count)
+    {
+        int digits = 0;
+        *count = ParseDigits(p, end, &digits);
+        if (digits == 0)
+        {
+            return "expected the mountain count";
+        }
+        if (digits > 19)
+        {
+            *p -= digits;
+            return "number out of range";
+        }
+        return NULL;
+    }
+
+    const char* ParseMountainFields(const char** p, const char* end, Mountain* m)
+    {
+        const char* reason = ParseInt(p, end, &m->left);
+        if (reason)
+        {
+            return reason;
+        }
+        if (*p == end || **p != ',')
+        {
+            return "expected ','";
+        }
+        ++*p;
+        if ((reason = ParseInt(p, end, &m->right)) != NULL)
+        {
+            return reason;
+        }
+        if (*p == end || **p != ',')
+        {
+            return "expected ','";
+        }
+        ++*p;
+        return ParseInt(p, end, &m->height);
+    }
+
+    bool ParseMountains(const char* input, size_t len, std::vector<Mountain>* mountains, ParseError* error)
+    {
+        const char* p = input;
+        const char* end = input + len;
+
+        uint64_t count = 0;
+        const char* reason = ParseMountainCount(&p, end, &count);
+        if (reason)
+        {
+            return Fail(input, p, reason, mountains, error);
+        }
+        if (count > static_cast<uint64_t>(end - p) / kMinLineLength)
+        {
+            return Fail(input, input, "mountain count exceeds the input", mountains, error);
+        }
+
+        mountains->resize(static_cast<size_t>(count));
+        Mountain* out = mountains->data();
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            if (p != end && *p == '\r')
+            {
+                ++p;
+            }
+            if (p == end || *p != '\n')
+            {
+                return Fail(input, p, "expected a line break", mountains, error);
+            }
+            ++p;
+
+            if ((reason = ParseMountainFields(&p, end, &out[i])) != NULL)
+            {
+                return Fail(input, p, reason, mountains, error);
+            }
+        }
+
+        for (; p != end; ++p)
+        {
+            if (!IsSpace(*p))
+            {
+                return Fail(input, p, "unexpected text after the last mountain", mountains, error);
+            }
+        }
+        return true;
+    }
+
+    bool ParseMountains(const char* input, std::vector<Mountain>* mountains, ParseError* error)
+    {
+        return ParseMountains(input, strlen(input), mountains, error);
+    }
+}
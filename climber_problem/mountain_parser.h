@@ -0,0 +1,44 @@
+#ifndef QIHOO_CLIMBER_MOUNTAIN_PARSER_H_
+#define QIHOO_CLIMBER_MOUNTAIN_PARSER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "skyline.h"
+
+namespace qh
+{
+    //! Where and why the input was rejected
+    struct ParseError
+    {
+        size_t      offset;     //! byte offset into the input
+        const char* reason;     //! static string
+    };
+
+    //! \brief Parse the leading mountain count at *p
+    //! \return - const char * - NULL on success, else the reason with *p on the offending byte
+    const char* ParseMountainCount(const char** p, const char* end, uint64_t* count);
+
+    //! \brief Parse one "l,r,h" at *p and leave *p right after it
+    //! \return - const char * - NULL on success, else the reason with *p on the offending byte
+    const char* ParseMountainFields(const char** p, const char* end, Mountain* m);
+
+    //! \brief Parse the "n\nl,r,h\nl,r,h..." problem input in a single pass.
+    //!   Numbers are decimal ints with an optional '-', lines may end in "\r\n" and
+    //!   only white space may follow the last mountain.
+    //!   Nothing is allocated except mountains itself, which is resized once to n.
+    //!   n is checked against the input length first, so a bogus count can not
+    //!   trigger a huge allocation.
+    //! \param[in] - const char * input - need not be NUL terminated
+    //! \param[in] - size_t len
+    //! \param[out] - std::vector<Mountain> * mountains - replaced, empty on failure
+    //! \param[out] - ParseError * error - filled on failure, may be NULL
+    //! \return - bool - false if the text is malformed
+    bool ParseMountains(const char* input, size_t len, std::vector<Mountain>* mountains, ParseError* error = NULL);
+
+    //! \brief The same for a NUL terminated input
+    bool ParseMountains(const char* input, std::vector<Mountain>* mountains, ParseError* error = NULL);
+}
+
+#endif //QIHOO_CLIMBER_MOUNTAIN_PARSER_H_
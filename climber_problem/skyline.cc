@@ -0,0 +1,204 @@
+#include "skyline.h"
+#include "work_stealing_pool.h"
+
+#include <algorithm>
+#include <queue>
+
+namespace qh
+{
+    namespace
+    {
+        bool LeftLess(const Mountain& a, const Mountain& b)
+        {
+            return a.left < b.left;
+        }
+
+        // The highest mountain still standing is at the top of the heap. Mountains
+        // that already ended are only dropped when they reach the top.
+        struct Active
+        {
+            int height;
+            int right;
+
+            bool operator<(const Active& rhs) const
+            {
+                return height < rhs.height;
+            }
+        };
+
+        // x only grows from call to call
+        void AppendPoint(Skyline* skyline, int x, int height)
+        {
+            int last = skyline->empty() ? 0 : skyline->back().height;
+            if (last != height)
+            {
+                SkylinePoint p = {x, height};
+                skyline->push_back(p);
+            }
+        }
+
+        // Solves [mountains, mountains + n) into out, forking the left half off
+        class SolveTask : public WorkStealingPool::Task
+        {
+        public:
+            SolveTask(const Mountain* mountains, size_t n, size_t grain)
+                : mountains_(mountains), n_(n), grain_(grain) {}
+
+            virtual void Execute(WorkStealingPool* pool, size_t worker)
+            {
+                if (n_ <= grain_)
+                {
+                    ComputeSkyline(mountains_, n_, &out);
+                    return;
+                }
+
+                size_t half = n_ / 2;
+                SolveTask left(mountains_, half, grain_);
+                SolveTask right(mountains_ + half, n_ - half, grain_);
+                pool->Spawn(worker, &left);
+                right.Execute(pool, worker);
+                pool->Wait(worker, &left);
+                MergeSkylines(left.out, right.out, &out);
+            }
+
+            Skyline out;
+
+        private:
+            const Mountain* mountains_;
+            size_t          n_;
+            size_t          grain_;
+        };
+    }
+
+    void ComputeSkyline(const Mountain* mountains, size_t n, Skyline* skyline)
+    {
+        skyline->clear();
+
+        std::vector<Mountain> sorted;
+        sorted.reserve(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (mountains[i].left < mountains[i].right && mountains[i].height > 0)
+            {
+                sorted.push_back(mountains[i]);
+            }
+        }
+        std::sort(sorted.begin(), sorted.end(), LeftLess);
+
+        std::vector<Active> heap_storage;
+        heap_storage.reserve(sorted.size());
+        std::priority_queue<Active> active(std::less<Active>(), heap_storage);
+
+        size_t next = 0;
+        while (next < sorted.size() || !active.empty())
+        {
+            // the next x where the outline can change: a left edge or the end of
+            // the current highest mountain
+            int x;
+            if (active.empty() || (next < sorted.size() && sorted[next].left <= active.top().right))
+            {
+                x = sorted[next].left;
+            }
+            else
+            {
+                x = active.top().right;
+            }
+
+            for (; next < sorted.size() && sorted[next].left == x; ++next)
+            {
+                Active a = {sorted[next].height, sorted[next].right};
+                active.push(a);
+            }
+            while (!active.empty() && active.top().right <= x)
+            {
+                active.pop();
+            }
+
+            AppendPoint(skyline, x, active.empty() ? 0 : active.top().height);
+        }
+    }
+
+    void MergeSkylines(const Skyline& a, const Skyline& b, Skyline* merged)
+    {
+        merged->clear();
+        merged->reserve(a.size() + b.size());
+
+        // walk both outlines left to right, remembering the current height of each
+        size_t i = 0;
+        size_t j = 0;
+        int ha = 0;
+        int hb = 0;
+        while (i < a.size() || j < b.size())
+        {
+            int x;
+            if (j == b.size() || (i < a.size() && a[i].x <= b[j].x))
+            {
+                x = a[i].x;
+            }
+            else
+            {
+                x = b[j].x;
+            }
+
+            if (i < a.size() && a[i].x == x)
+            {
+                ha = a[i++].height;
+            }
+            if (j < b.size() && b[j].x == x)
+            {
+                hb = b[j++].height;
+            }
+            AppendPoint(merged, x, ha > hb ? ha : hb);
+        }
+    }
+
+    void ComputeSkylineParallel(const Mountain* mountains, size_t n, WorkStealingPool* pool,
+        Skyline* skyline, size_t grain)
+    {
+        if (grain == 0)
+        {
+            grain = 1;
+        }
+        SolveTask root(mountains, n, grain);
+        pool->Run(&root);
+        skyline->swap(root.out);
+    }
+
+    int64_t CountSteps(const Skyline& skyline)
+    {
+        if (skyline.empty())
+        {
+            return 0;
+        }
+
+        int64_t steps = skyline.back().x;
+        int previous = 0;
+        for (size_t i = 0; i < skyline.size(); ++i)
+        {
+            int64_t delta = static_cast<int64_t>(skyline[i].height) - previous;
+            steps += delta < 0 ? -delta : delta;
+            previous = skyline[i].height;
+        }
+        return steps;
+    }
+
+    int64_t ClimbSteps(const Mountain* mountains, size_t n)
+    {
+        Skyline skyline;
+        ComputeSkyline(mountains, n, &skyline);
+        return CountSteps(skyline);
+    }
+
+    int64_t ClimbStepsParallel(const Mountain* mountains, size_t n, size_t threads)
+    {
+        if (threads <= 1 || n <= kParallelSkylineGrain)
+        {
+            return ClimbSteps(mountains, n);
+        }
+
+        WorkStealingPool pool(threads);
+        Skyline skyline;
+        ComputeSkylineParallel(mountains, n, &pool, &skyline);
+        return CountSteps(skyline);
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef QIHOO_CLIMBER_SKYLINE_H_
+#define QIHOO_CLIMBER_SKYLINE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace qh
+{
+    //! A rectangle mountain standing on [left, right) with the given height
+    struct Mountain
+    {
+        int left;
+        int right;
+        int height;
+    };
+
+    //! The outline has height `height` from x up to the next point's x
+    struct SkylinePoint
+    {
+        int x;
+        int height;
+
+        bool operator==(const SkylinePoint& rhs) const
+        {
+            return x == rhs.x && height == rhs.height;
+        }
+    };
+
+    typedef std::vector<SkylinePoint> Skyline;
+
+    //! \brief Compute the outline of the mountains with a sweep line over their edges.
+    //!   The result is canonical: heights of consecutive points differ and the last
+    //!   point is at the right-most edge with height 0. Mountains with left >= right
+    //!   or height <= 0 are ignored.
+    //!   Time O(n log n), memory O(n).
+    //! \param[in] - const Mountain * mountains
+    //! \param[in] - size_t n
+    //! \param[out] - Skyline * skyline - cleared first
+    void ComputeSkyline(const Mountain* mountains, size_t n, Skyline* skyline);
+
+    //! \brief Merge two canonical outlines into the canonical outline of their union.
+    //!   O(a.size() + b.size()).
+    //! \param[out] - Skyline * merged - cleared first, must not alias a or b
+    void MergeSkylines(const Skyline& a, const Skyline& b, Skyline* merged);
+
+    class WorkStealingPool;
+
+    //! Below this many mountains a piece is solved serially instead of split again
+    const size_t kParallelSkylineGrain = 16384;
+
+    //! \brief ComputeSkyline() on every worker of the pool: the mountains are split in
+    //!   halves down to grain, the pieces are solved by whichever worker gets to them and
+    //!   merged pairwise on the way back up. The result is identical to ComputeSkyline().
+    //!   Runs on the calling thread as worker 0, one call at a time per pool.
+    void ComputeSkylineParallel(const Mountain* mountains, size_t n, WorkStealingPool* pool,
+        Skyline* skyline, size_t grain = kParallelSkylineGrain);
+
+    //! \brief Steps the climber walks from position 0 to the end of the outline:
+    //!   the horizontal distance plus every climb up and down. O(size of outline).
+    int64_t CountSteps(const Skyline& skyline);
+
+    //! \brief ComputeSkyline() followed by CountSteps()
+    int64_t ClimbSteps(const Mountain* mountains, size_t n);
+
+    //! \brief ComputeSkylineParallel() on a pool of the given size followed by CountSteps().
+    //!   threads <= 1 is the serial ClimbSteps().
+    int64_t ClimbStepsParallel(const Mountain* mountains, size_t n, size_t threads);
+}
+
+#endif //QIHOO_CLIMBER_SKYLINE_H_
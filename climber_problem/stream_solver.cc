@@ -0,0 +1,492 @@
+#include "stream_solver.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <map>
+#include <queue>
+#include <string>
+#include <vector>
+
+namespace qh
+{
+    namespace
+    {
+        // A rise by height at a left edge or a fall by -height at a right edge
+        struct Event
+        {
+            int x;
+            int height;
+        };
+
+        inline bool EventLess(const Event& a, const Event& b)
+        {
+            return a.x != b.x ? a.x < b.x : a.height < b.height;
+        }
+
+        const size_t kMinBlockSize = 4096;
+        const size_t kMinRunEvents = 1024;
+        // smallest read buffer of one run during a merge
+        const size_t kMinMergeEvents = 512;
+
+        bool Fail(ParseError* error, uint64_t offset, const char* reason)
+        {
+            if (error)
+            {
+                error->offset = static_cast<size_t>(offset);
+                error->reason = reason;
+            }
+            return false;
+        }
+
+        // The same wording as ParseMountains() for a line that goes on too long
+        const char* LineEndReason(bool last)
+        {
+            return last ? "unexpected text after the last mountain" : "expected a line break";
+        }
+
+        // Consumes events in x order and adds up the steps
+        class Sweep
+        {
+        public:
+            Sweep() : started_(false), x_(0), height_(0), variation_(0) {}
+
+            void Push(const Event& e)
+            {
+                if (started_ && e.x != x_)
+                {
+                    Close();
+                }
+                started_ = true;
+                x_ = e.x;
+
+                // a fall may be seen before the rise at the same x, the count
+                // is only trusted once the whole x is done
+                int h = e.height > 0 ? e.height : -e.height;
+                int& count = active_[h];
+                count += e.height > 0 ? 1 : -1;
+                if (count == 0)
+                {
+                    active_.erase(h);
+                }
+            }
+
+            //! The last event is the right-most edge, where the outline ends
+            int64_t Finish()
+            {
+                if (!started_)
+                {
+                    return 0;
+                }
+                Close();
+                return static_cast<int64_t>(x_) + variation_;
+            }
+
+        private:
+            void Close()
+            {
+                int h = active_.empty() ? 0 : active_.rbegin()->first;
+                variation_ += h > height_ ? h - height_ : height_ - h;
+                height_ = h;
+            }
+
+        private:
+            std::map<int, int>  active_;    // height -> number of mountains standing
+            bool                started_;
+            int                 x_;
+            int                 height_;
+            int64_t             variation_;
+        };
+
+        // Owns the temporary files, they are already unlinked
+        class RunSet
+        {
+        public:
+            ~RunSet()
+            {
+                for (size_t i = 0; i < runs.size(); ++i)
+                {
+                    fclose(runs[i]);
+                }
+            }
+
+            FILE* Create(const char* dir)
+            {
+                if (!dir)
+                {
+                    dir = getenv("TMPDIR");
+                }
+                std::string path = std::string(dir && *dir ? dir : "/tmp") + "/qh_climber_run_XXXXXX";
+                int fd = mkstemp(&path[0]);
+                if (fd < 0)
+                {
+                    return NULL;
+                }
+                unlink(path.c_str());
+                FILE* f = fdopen(fd, "w+b");
+                if (!f)
+                {
+                    close(fd);
+                    return NULL;
+                }
+                runs.push_back(f);
+                return f;
+            }
+
+            void Close(size_t first, size_t last)
+            {
+                for (size_t i = first; i < last; ++i)
+                {
+                    fclose(runs[i]);
+                }
+                runs.erase(runs.begin() + first, runs.begin() + last);
+            }
+
+            std::vector<FILE*> runs;
+        };
+
+        bool Spill(std::vector<Event>* events, RunSet* runs, const char* dir)
+        {
+            std::sort(events->begin(), events->end(), EventLess);
+            FILE* f = runs->Create(dir);
+            if (!f)
+            {
+                return false;
+            }
+            if (fwrite(events->data(), sizeof(Event), events->size(), f) != events->size() || fflush(f) != 0)
+            {
+                return false;
+            }
+            events->clear();
+            return true;
+        }
+
+        class RunReader
+        {
+        public:
+            RunReader(FILE* f, size_t buffer_events)
+                : file_(f), buffer_(buffer_events), pos_(0), len_(0) {}
+
+            //! \return - bool - false at the end of the run or on a read error
+            bool Next(Event* e)
+            {
+                if (pos_ == len_)
+                {
+                    len_ = fread(buffer_.data(), sizeof(Event), buffer_.size(), file_);
+                    pos_ = 0;
+                    if (len_ == 0)
+                    {
+                        return false;
+                    }
+                }
+                *e = buffer_[pos_++];
+                return true;
+            }
+
+            bool failed() const { return ferror(file_) != 0; }
+
+        private:
+            FILE*               file_;
+            std::vector<Event>  buffer_;
+            size_t              pos_;
+            size_t              len_;
+        };
+
+        class RunWriter
+        {
+        public:
+            RunWriter(FILE* f, size_t buffer_events) : file_(f), ok_(true)
+            {
+                buffer_.reserve(buffer_events);
+            }
+
+            bool operator()(const Event& e)
+            {
+                buffer_.push_back(e);
+                return buffer_.size() < buffer_.capacity() || Flush();
+            }
+
+            bool Flush()
+            {
+                ok_ = ok_ && fwrite(buffer_.data(), sizeof(Event), buffer_.size(), file_) == buffer_.size();
+                buffer_.clear();
+                return ok_;
+            }
+
+        private:
+            FILE*               file_;
+            std::vector<Event>  buffer_;
+            bool                ok_;
+        };
+
+        class SweepSink
+        {
+        public:
+            explicit SweepSink(Sweep* sweep) : sweep_(sweep) {}
+
+            bool operator()(const Event& e)
+            {
+                sweep_->Push(e);
+                return true;
+            }
+
+        private:
+            Sweep* sweep_;
+        };
+
+        struct HeapItem
+        {
+            Event   event;
+            size_t  run;
+
+            bool operator<(const HeapItem& rhs) const
+            {
+                // std::priority_queue pops the largest, we want the smallest event
+                return EventLess(rhs.event, event);
+            }
+        };
+
+        //! \brief k-way merge of runs [first, last) into sink
+        template<class Sink>
+        bool MergeRuns(RunSet* runs, size_t first, size_t last, size_t buffer_events, Sink& sink)
+        {
+            std::vector<RunReader*> readers;
+            std::priority_queue<HeapItem> heap;
+            bool ok = true;
+            for (size_t i = first; i < last; ++i)
+            {
+                rewind(runs->runs[i]);
+                readers.push_back(new RunReader(runs->runs[i], buffer_events));
+                HeapItem item = {{0, 0}, readers.size() - 1};
+                if (readers.back()->Next(&item.event))
+                {
+                    heap.push(item);
+                }
+            }
+
+            while (ok && !heap.empty())
+            {
+                HeapItem item = heap.top();
+                heap.pop();
+                ok = sink(item.event);
+                if (readers[item.run]->Next(&item.event))
+                {
+                    heap.push(item);
+                }
+            }
+
+            for (size_t i = 0; i < readers.size(); ++i)
+            {
+                ok = ok && !readers[i]->failed();
+                delete readers[i];
+            }
+            return ok;
+        }
+
+        // Hands out the input one line at a time from a block sized buffer
+        class LineReader
+        {
+        public:
+            LineReader(FILE* f, size_t block_size)
+                : file_(f), block_(block_size), pos_(0), filled_(0), base_(0), eof_(false), failed_(false) {}
+
+            //! \brief [*begin, *end) is the next line without its "\r\n"
+            //! \return - bool - false at the end of the input, on a read error or a line longer than the block
+            bool Next(const char** begin, const char** end)
+            {
+                for (;;)
+                {
+                    char* start = &block_[0] + pos_;
+                    char* nl = static_cast<char*>(memchr(start, '\n', filled_ - pos_));
+                    if (nl || (eof_ && pos_ < filled_))
+                    {
+                        char* stop = nl ? nl : &block_[0] + filled_;
+                        pos_ = stop - &block_[0] + (nl ? 1 : 0);
+                        if (stop != start && stop[-1] == '\r')
+                        {
+                            --stop;
+                        }
+                        *begin = start;
+                        *end = stop;
+                        return true;
+                    }
+                    if (eof_ || !Fill())
+                    {
+                        return false;
+                    }
+                }
+            }
+
+            //! \brief Offset in the stream of a byte of the current block
+            uint64_t OffsetOf(const char* p) const
+            {
+                return base_ + (p - &block_[0]);
+            }
+
+            uint64_t offset() const { return base_ + pos_; }
+            bool failed() const { return failed_; }
+
+        private:
+            bool Fill()
+            {
+                // keep the partial line, it moves to the front of the block
+                memmove(&block_[0], &block_[0] + pos_, filled_ - pos_);
+                base_ += pos_;
+                filled_ -= pos_;
+                pos_ = 0;
+                if (filled_ == block_.size())
+                {
+                    failed_ = true;
+                    return false;
+                }
+
+                size_t n = fread(&block_[0] + filled_, 1, block_.size() - filled_, file_);
+                filled_ += n;
+                if (n == 0)
+                {
+                    eof_ = true;
+                    failed_ = ferror(file_) != 0;
+                    return !failed_ && filled_ > 0;
+                }
+                return true;
+            }
+
+        private:
+            FILE*               file_;
+            std::vector<char>   block_;
+            size_t              pos_;
+            size_t              filled_;
+            uint64_t            base_;      // stream offset of block_[0]
+            bool                eof_;
+            bool                failed_;
+        };
+    }
+
+    bool StreamClimbSteps(FILE* input, const StreamOptions& options, int64_t* steps, ParseError* error)
+    {
+        size_t budget = options.memory_budget;
+        size_t block_size = std::max(kMinBlockSize, budget / 8);
+        size_t run_events = std::max(kMinRunEvents, (budget > block_size ? budget - block_size : 0) / sizeof(Event));
+
+        RunSet runs;
+        std::vector<Event> events;
+        events.reserve(run_events);
+        {
+            LineReader reader(input, block_size);
+            const char* begin = NULL;
+            const char* end = NULL;
+            if (!reader.Next(&begin, &end))
+            {
+                return Fail(error, reader.offset(), reader.failed() ? "read error or line too long" : "expected the mountain count");
+            }
+            uint64_t count = 0;
+            const char* p = begin;
+            const char* reason = ParseMountainCount(&p, end, &count);
+            if (reason || p != end)
+            {
+                return Fail(error, reader.OffsetOf(p), reason ? reason : LineEndReason(count == 0));
+            }
+
+            for (uint64_t i = 0; i < count; ++i)
+            {
+                if (!reader.Next(&begin, &end))
+                {
+                    return Fail(error, reader.offset(), reader.failed() ? "read error or line too long" : "expected a line break");
+                }
+                Mountain m;
+                p = begin;
+                if ((reason = ParseMountainFields(&p, end, &m)) != NULL || p != end)
+                {
+                    return Fail(error, reader.OffsetOf(p), reason ? reason : LineEndReason(i + 1 == count));
+                }
+                if (m.left >= m.right || m.height <= 0)
+                {
+                    continue;
+                }
+
+                if (events.size() + 2 > run_events && !Spill(&events, &runs, options.temp_dir))
+                {
+                    return Fail(error, reader.offset(), "cannot write a temporary run");
+                }
+                Event rise = {m.left, m.height};
+                Event fall = {m.right, -m.height};
+                events.push_back(rise);
+                events.push_back(fall);
+            }
+
+            while (reader.Next(&begin, &end))
+            {
+                for (p = begin; p != end; ++p)
+                {
+                    if (*p != ' ' && *p != '\t' && *p != '\r')
+                    {
+                        return Fail(error, reader.OffsetOf(p), "unexpected text after the last mountain");
+                    }
+                }
+            }
+            if (reader.failed())
+            {
+                return Fail(error, reader.offset(), "read error or line too long");
+            }
+        }
+
+        Sweep sweep;
+        if (runs.runs.empty())
+        {
+            std::sort(events.begin(), events.end(), EventLess);
+            for (size_t i = 0; i < events.size(); ++i)
+            {
+                sweep.Push(events[i]);
+            }
+            *steps = sweep.Finish();
+            return true;
+        }
+
+        if (!events.empty() && !Spill(&events, &runs, options.temp_dir))
+        {
+            return Fail(error, 0, "cannot write a temporary run");
+        }
+        std::vector<Event>().swap(events);
+
+        // one buffer per merged run plus one for the output
+        size_t slots = budget / (kMinMergeEvents * sizeof(Event));
+        size_t fan_in = slots > 3 ? slots - 1 : 2;
+        size_t buffer_events = std::max(kMinMergeEvents, budget / (fan_in + 1) / sizeof(Event));
+        while (runs.runs.size() > fan_in)
+        {
+            // merge the oldest runs into a new one at the back
+            FILE* out = runs.Create(options.temp_dir);
+            if (!out)
+            {
+                return Fail(error, 0, "cannot write a temporary run");
+            }
+            RunWriter writer(out, buffer_events);
+            if (!MergeRuns(&runs, 0, fan_in, buffer_events, writer) || !writer.Flush() || fflush(out) != 0)
+            {
+                return Fail(error, 0, "cannot merge temporary runs");
+            }
+            runs.Close(0, fan_in);
+        }
+
+        SweepSink sink(&sweep);
+        if (!MergeRuns(&runs, 0, runs.runs.size(), buffer_events, sink))
+        {
+            return Fail(error, 0, "cannot read a temporary run");
+        }
+        *steps = sweep.Finish();
+        return true;
+    }
+
+    bool StreamClimbSteps(const char* path, const StreamOptions& options, int64_t* steps, ParseError* error)
+    {
+        FILE* f = fopen(path, "rb");
+        if (!f)
+        {
+            return Fail(error, 0, "cannot open the input");
+        }
+        bool ok = StreamClimbSteps(f, options, steps, error);
+        fclose(f);
+        return ok;
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef QIHOO_CLIMBER_STREAM_SOLVER_H_
+#define QIHOO_CLIMBER_STREAM_SOLVER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "mountain_parser.h"
+
+namespace qh
+{
+    struct StreamOptions
+    {
+        //! Bytes for the read block, the event runs and the merge buffers together
+        size_t      memory_budget;
+        //! Where sorted runs are spilled, NULL means $TMPDIR or /tmp
+        const char* temp_dir;
+
+        StreamOptions() : memory_budget(64 << 20), temp_dir(NULL) {}
+    };
+
+    /**
+    * Solves inputs that do not fit in memory.
+    *
+    * The input is read block by block. Every mountain becomes a rise event at
+    * its left edge and a fall event at its right edge; events are collected
+    * until the budget is used up, sorted and spilled to a temporary file. The
+    * sorted runs are then merged k at a time, in several passes if there are
+    * more runs than buffers fit in the budget, and the last merge feeds the
+    * sweep directly. Inputs that fit the budget never touch the disk.
+    *
+    * The budget covers the buffers this function allocates. The sweep also
+    * keeps the heights of the mountains standing at the current x, which is
+    * bounded by the deepest overlap rather than by the budget.
+    * Temporary files are unlinked as soon as they are created.
+    *
+    * \param[in] - FILE * input - the "n\nl,r,h..." text, read from the current position
+    * \param[out] - int64_t * steps - the same as ClimbSteps() on the whole input
+    * \param[out] - ParseError * error - offset into the stream on malformed
+    *   input, or the failed I/O operation. May be NULL.
+    * \return - bool
+    */
+    bool StreamClimbSteps(FILE* input, const StreamOptions& options, int64_t* steps, ParseError* error = NULL);
+
+    //! \brief The same for a file name
+    bool StreamClimbSteps(const char* path, const StreamOptions& options, int64_t* steps, ParseError* error = NULL);
+}
+
+#endif //QIHOO_CLIMBER_STREAM_SOLVER_H_
@@ -0,0 +1,140 @@
+#include "work_stealing_pool.h"
+
+#include <assert.h>
+
+namespace qh
+{
+    WorkStealingPool::WorkStealingPool(size_t threads)
+        : queued_(0), stop_(false)
+    {
+        if (threads == 0)
+        {
+            threads = 1;
+        }
+        for (size_t i = 0; i < threads; ++i)
+        {
+            queues_.push_back(new Queue);
+        }
+        for (size_t i = 1; i < threads; ++i)
+        {
+            threads_.push_back(std::thread(&WorkStealingPool::WorkerLoop, this, i));
+        }
+    }
+
+    WorkStealingPool::~WorkStealingPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(idle_mutex_);
+            stop_ = true;
+        }
+        idle_.notify_all();
+        for (size_t i = 0; i < threads_.size(); ++i)
+        {
+            threads_[i].join();
+        }
+        for (size_t i = 0; i < queues_.size(); ++i)
+        {
+            assert(queues_[i]->tasks.empty());
+            delete queues_[i];
+        }
+    }
+
+    void WorkStealingPool::Spawn(size_t worker, Task* task)
+    {
+        assert(worker < queues_.size());
+        {
+            std::lock_guard<std::mutex> lock(queues_[worker]->mutex);
+            queues_[worker]->tasks.push_back(task);
+        }
+        queued_.fetch_add(1);
+        if (!threads_.empty())
+        {
+            // taking the mutex orders us after a worker that checked queued_
+            // and is about to sleep, so the notification can not get lost
+            std::lock_guard<std::mutex> lock(idle_mutex_);
+            idle_.notify_one();
+        }
+    }
+
+    void WorkStealingPool::Wait(size_t worker, Task* task)
+    {
+        while (!task->done_.load(std::memory_order_acquire))
+        {
+            Task* other = PopOrSteal(worker);
+            if (other)
+            {
+                Execute(other, worker);
+            }
+            else
+            {
+                // the task is running on another worker
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void WorkStealingPool::Run(Task* root)
+    {
+        Execute(root, 0);
+    }
+
+    WorkStealingPool::Task* WorkStealingPool::PopOrSteal(size_t worker)
+    {
+        if (queued_.load() == 0)
+        {
+            return NULL;
+        }
+
+        Task* task = NULL;
+        {
+            Queue* own = queues_[worker];
+            std::lock_guard<std::mutex> lock(own->mutex);
+            if (!own->tasks.empty())
+            {
+                task = own->tasks.back();
+                own->tasks.pop_back();
+            }
+        }
+        for (size_t i = 1; !task && i < queues_.size(); ++i)
+        {
+            Queue* victim = queues_[(worker + i) % queues_.size()];
+            std::lock_guard<std::mutex> lock(victim->mutex);
+            if (!victim->tasks.empty())
+            {
+                task = victim->tasks.front();
+                victim->tasks.pop_front();
+            }
+        }
+        if (task)
+        {
+            queued_.fetch_sub(1);
+        }
+        return task;
+    }
+
+    void WorkStealingPool::Execute(Task* task, size_t worker)
+    {
+        task->Execute(this, worker);
+        task->done_.store(true, std::memory_order_release);
+    }
+
+    void WorkStealingPool::WorkerLoop(size_t worker)
+    {
+        for (;;)
+        {
+            Task* task = PopOrSteal(worker);
+            if (task)
+            {
+                Execute(task, worker);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(idle_mutex_);
+            idle_.wait(lock, [this]() { return stop_ || queued_.load() != 0; });
+            if (stop_)
+            {
+                return;
+            }
+        }
+    }
+}
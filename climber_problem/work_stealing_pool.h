@@ -0,0 +1,83 @@
+#ifndef QIHOO_CLIMBER_WORK_STEALING_POOL_H_
+#define QIHOO_CLIMBER_WORK_STEALING_POOL_H_
+
+#include <stddef.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace qh
+{
+    /**
+    * A fork-join thread pool with one task deque per worker.
+    *
+    * A worker pushes the tasks it spawns to the back of its own deque and pops
+    * from the back, so it keeps working on the most recent, cache-hot part of
+    * the problem. An idle worker steals from the front of somebody else's deque,
+    * which is where the oldest and therefore biggest pieces of work are.
+    *
+    * The thread that calls into the pool is worker 0; the pool starts
+    * threads - 1 more. Every call takes the index of the worker it runs on,
+    * which Task::Execute() receives, so no thread local state is needed.
+    */
+    class WorkStealingPool
+    {
+    public:
+        class Task
+        {
+        public:
+            Task() : done_(false) {}
+            virtual ~Task() {}
+
+            virtual void Execute(WorkStealingPool* pool, size_t worker) = 0;
+
+        private:
+            friend class WorkStealingPool;
+            std::atomic<bool> done_;
+        };
+
+        //! \param[in] - size_t threads - total workers including the calling thread, at least 1
+        explicit WorkStealingPool(size_t threads);
+        ~WorkStealingPool();
+
+        size_t size() const { return queues_.size(); }
+
+        //! \brief Make task available to every worker. It must outlive the matching Wait().
+        void Spawn(size_t worker, Task* task);
+
+        //! \brief Run other tasks until task is done
+        void Wait(size_t worker, Task* task);
+
+        //! \brief Execute root on the calling thread as worker 0 and wait for it
+        void Run(Task* root);
+
+    private:
+        struct Queue
+        {
+            std::mutex          mutex;
+            std::deque<Task*>   tasks;
+        };
+
+        Task* PopOrSteal(size_t worker);
+        void Execute(Task* task, size_t worker);
+        void WorkerLoop(size_t worker);
+
+    private:
+        std::vector<Queue*>         queues_;
+        std::vector<std::thread>    threads_;
+
+        // sleeping workers wait for queued_ to become non zero
+        std::atomic<size_t>         queued_;
+        std::mutex                  idle_mutex_;
+        std::condition_variable     idle_;
+        bool                        stop_;
+
+        WorkStealingPool(const WorkStealingPool&);
+        WorkStealingPool& operator=(const WorkStealingPool&);
+    };
+}
+
+#endif //QIHOO_CLIMBER_WORK_STEALING_POOL_H_
@@ -0,0 +1,156 @@
+#ifndef QIHOO_BENCH_H_
+#define QIHOO_BENCH_H_
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include <atomic>
+#include <new>
+
+#include "qh_random.h"
+
+/**
+* Helpers for the bench/ programs of every module.
+*
+* Every result is printed as one JSON object per line, so runs of different
+* versions can be diffed or loaded into a script:
+*   {"suite":"bench_string","bench":"string/pool","ops":1000000,"ns_per_op":21.30,"ops_per_sec":46948357,"allocs_per_op":0.00}
+*   {"suite":"bench_parse","bench":"ParseMountains/n=1000","metric":"MB/s","value":428.88}
+*
+* This header replaces the global operator new and delete to count
+* allocations, so it must be included by exactly one translation unit of a
+* benchmark program, its main .cc file, and never by library code.
+*/
+
+namespace qh
+{
+namespace bench
+{
+    inline std::atomic<uint64_t>& AllocationCounter()
+    {
+        static std::atomic<uint64_t> counter(0);
+        return counter;
+    }
+
+    //! \brief Number of calls to the global operator new so far
+    inline uint64_t Allocations()
+    {
+        return AllocationCounter().load(std::memory_order_relaxed);
+    }
+
+    inline uint64_t NowNanos()
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+    }
+
+    //! \brief Keep the compiler from optimizing away a computed value
+    template<class T>
+    inline void DoNotOptimize(const T& value)
+    {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    //! The seed every dataset starts from, unless QH_BENCH_SEED overrides it
+    const uint64_t kDefaultSeed = kDefaultRandomSeed;
+
+    inline uint64_t Seed()
+    {
+        const char* env = getenv("QH_BENCH_SEED");
+        return env && *env ? strtoull(env, NULL, 10) : kDefaultSeed;
+    }
+
+    //! Seeded with Seed() unless told otherwise
+    class Random : public qh::Random
+    {
+    public:
+        explicit Random(uint64_t seed = Seed()) : qh::Random(seed) {}
+    };
+
+    //! \brief Name of the running benchmark program, the "suite" of its results
+    inline const char* Suite()
+    {
+        return program_invocation_short_name;
+    }
+
+    inline void PrintString(const char* s)
+    {
+        putchar('"');
+        for (; *s; ++s)
+        {
+            if (*s == '"' || *s == '\\')
+            {
+                putchar('\\');
+            }
+            putchar(*s);
+        }
+        putchar('"');
+    }
+
+    //! \brief Time fn(), which is expected to perform ops operations, and print
+    //!   the cost and the allocations per op
+    //! \return - double - ns per op
+    template<class Fn>
+    inline double Run(const char* name, uint64_t ops, Fn fn)
+    {
+        uint64_t allocations = Allocations();
+        uint64_t begin = NowNanos();
+        fn();
+        uint64_t elapsed = NowNanos() - begin;
+        allocations = Allocations() - allocations;
+
+        double ns_per_op = ops ? static_cast<double>(elapsed) / ops : 0.0;
+        double ops_per_sec = elapsed ? ops * 1e9 / elapsed : 0.0;
+        double allocs_per_op = ops ? static_cast<double>(allocations) / ops : 0.0;
+        printf("{\"suite\":");
+        PrintString(Suite());
+        printf(",\"bench\":");
+        PrintString(name);
+        printf(",\"ops\":%llu,\"ns_per_op\":%.2f,\"ops_per_sec\":%.0f,\"allocs_per_op\":%.2f}\n",
+            static_cast<unsigned long long>(ops), ns_per_op, ops_per_sec, allocs_per_op);
+        fflush(stdout);
+        return ns_per_op;
+    }
+
+    //! \brief Print an extra named metric of a benchmark
+    inline void Report(const char* name, const char* metric, double value)
+    {
+        printf("{\"suite\":");
+        PrintString(Suite());
+        printf(",\"bench\":");
+        PrintString(name);
+        printf(",\"metric\":");
+        PrintString(metric);
+        printf(",\"value\":%.2f}\n", value);
+        fflush(stdout);
+    }
+}
+}
+
+// Not inlined: GCC would otherwise pair malloc/free with new/delete at the
+// call sites and warn about a mismatch (-Wmismatched-new-delete)
+__attribute__((noinline)) void* operator new(size_t size)
+{
+    qh::bench::AllocationCounter().fetch_add(1, std::memory_order_relaxed);
+    void* p = malloc(size ? size : 1);
+    if (!p)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+#endif //QIHOO_BENCH_H_
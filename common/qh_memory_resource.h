@@ -0,0 +1,406 @@
+#ifndef QIHOO_MEMORY_RESOURCE_H_
+#define QIHOO_MEMORY_RESOURCE_H_
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <new>
+
+#include "qh_metrics.h"
+
+namespace qh
+{
+    /**
+    * A polymorphic source of raw memory, modelled after std::pmr::memory_resource.
+    * qh::string and qh::vector take a memory_resource* so that the same container
+    * type can live on the heap, in a per-request arena or in a per-thread pool.
+    * A NULL resource always means get_default_resource().
+    */
+    class memory_resource
+    {
+    public:
+        static const size_t kMaxAlign = sizeof(void*) * 2;
+
+        virtual ~memory_resource() {}
+
+        void* allocate(size_t bytes, size_t alignment = kMaxAlign)
+        {
+            return do_allocate(bytes, alignment);
+        }
+
+        void deallocate(void* p, size_t bytes, size_t alignment = kMaxAlign)
+        {
+            do_deallocate(p, bytes, alignment);
+        }
+
+        //! \brief Memory allocated from this can be freed by other and vice versa
+        bool is_equal(const memory_resource& other) const
+        {
+            return this == &other || do_is_equal(other);
+        }
+
+    protected:
+        virtual void* do_allocate(size_t bytes, size_t alignment) = 0;
+        virtual void do_deallocate(void* p, size_t bytes, size_t alignment) = 0;
+        virtual bool do_is_equal(const memory_resource& /*other*/) const
+        {
+            return false;
+        }
+    };
+
+    /**
+    * Forwards to the global operator new/delete. This is what the containers used
+    * before they became resource aware. Alignments above kMaxAlign, which
+    * operator new does not promise, come from posix_memalign.
+    */
+    class new_delete_resource_impl : public memory_resource
+    {
+    protected:
+        virtual void* do_allocate(size_t bytes, size_t alignment)
+        {
+            heap_allocations().Add();
+            heap_bytes().Add(bytes);
+            if (alignment <= kMaxAlign)
+            {
+                return ::operator new(bytes);
+            }
+            void* p = NULL;
+            if (posix_memalign(&p, alignment, bytes) != 0)
+            {
+                throw std::bad_alloc();
+            }
+            return p;
+        }
+
+        virtual void do_deallocate(void* p, size_t /*bytes*/, size_t alignment)
+        {
+            heap_deallocations().Add();
+            if (alignment <= kMaxAlign)
+            {
+                ::operator delete(p);
+            }
+            else
+            {
+                free(p);
+            }
+        }
+
+    private:
+        // What the containers take from the heap, directly or through the
+        // upstream of an arena or a pool. No-ops unless QH_ENABLE_METRICS.
+        static metrics::Counter& heap_allocations()
+        {
+            static metrics::Counter counter("memory.heap.allocations");
+            return counter;
+        }
+
+        static metrics::Counter& heap_deallocations()
+        {
+            static metrics::Counter counter("memory.heap.deallocations");
+            return counter;
+        }
+
+        static metrics::Counter& heap_bytes()
+        {
+            static metrics::Counter counter("memory.heap.bytes");
+            return counter;
+        }
+    };
+
+    inline memory_resource* new_delete_resource()
+    {
+        static new_delete_resource_impl instance;
+        return &instance;
+    }
+
+    namespace detail
+    {
+        inline memory_resource*& default_resource_slot()
+        {
+            static memory_resource* slot = new_delete_resource();
+            return slot;
+        }
+
+        inline size_t align_up(size_t n, size_t alignment)
+        {
+            return (n + alignment - 1) & ~(alignment - 1);
+        }
+    }
+
+    inline memory_resource* get_default_resource()
+    {
+        return detail::default_resource_slot();
+    }
+
+    //! \brief Replace the default resource. NULL restores new_delete_resource().
+    //! \return - memory_resource* - the previous default resource
+    inline memory_resource* set_default_resource(memory_resource* r)
+    {
+        memory_resource* old = detail::default_resource_slot();
+        detail::default_resource_slot() = r ? r : new_delete_resource();
+        return old;
+    }
+
+    /**
+    * A bump allocator. Memory is carved linearly out of blocks obtained from the
+    * upstream resource, deallocate() is a no-op and everything is returned at once
+    * by release() or by the destructor. Meant for a per-request arena where
+    * thousands of short-lived strings and vectors die together.
+    * Not thread safe.
+    */
+    class arena_resource : public memory_resource
+    {
+    public:
+        explicit arena_resource(size_t block_size = 4096, memory_resource* upstream = NULL)
+            : upstream_(upstream ? upstream : get_default_resource())
+            , block_size_(block_size < 256 ? 256 : block_size)
+            , head_(NULL), cur_(NULL), end_(NULL)
+            , bytes_allocated_(0), bytes_reserved_(0), block_count_(0)
+        {
+        }
+
+        ~arena_resource()
+        {
+            release();
+        }
+
+        //! \brief Give every block back to the upstream resource
+        void release()
+        {
+            while (head_)
+            {
+                Block* next = head_->next;
+                upstream_->deallocate(head_, head_->size);
+                head_ = next;
+            }
+            cur_ = end_ = NULL;
+            bytes_allocated_ = bytes_reserved_ = 0;
+            block_count_ = 0;
+        }
+
+        //! \brief Bytes handed out to callers since the last release()
+        size_t bytes_allocated() const { return bytes_allocated_; }
+
+        //! \brief Bytes obtained from upstream, including block headers and padding
+        size_t bytes_reserved() const { return bytes_reserved_; }
+
+        size_t block_count() const { return block_count_; }
+
+    protected:
+        virtual void* do_allocate(size_t bytes, size_t alignment)
+        {
+            char* p = align_ptr(cur_, alignment);
+            if (!p || p + bytes > end_)
+            {
+                grow(bytes + alignment);
+                p = align_ptr(cur_, alignment);
+            }
+            cur_ = p + bytes;
+            bytes_allocated_ += bytes;
+            return p;
+        }
+
+        virtual void do_deallocate(void* /*p*/, size_t /*bytes*/, size_t /*alignment*/)
+        {
+        }
+
+    private:
+        struct Block
+        {
+            Block* next;
+            size_t size;
+        };
+
+        static char* align_ptr(char* p, size_t alignment)
+        {
+            return reinterpret_cast<char*>(detail::align_up(reinterpret_cast<size_t>(p), alignment));
+        }
+
+        void grow(size_t min_bytes)
+        {
+            size_t size = sizeof(Block) + min_bytes;
+            if (size < block_size_)
+            {
+                size = block_size_;
+            }
+            Block* b = static_cast<Block*>(upstream_->allocate(size));
+            b->next = head_;
+            b->size = size;
+            head_ = b;
+            cur_ = reinterpret_cast<char*>(b + 1);
+            end_ = reinterpret_cast<char*>(b) + size;
+            bytes_reserved_ += size;
+            ++block_count_;
+        }
+
+    private:
+        memory_resource* upstream_;
+        size_t block_size_;
+        Block* head_;
+        char*  cur_;
+        char*  end_;
+        size_t bytes_allocated_;
+        size_t bytes_reserved_;
+        size_t block_count_;
+
+        arena_resource(const arena_resource&);
+        arena_resource& operator=(const arena_resource&);
+    };
+
+    /**
+    * A size-class pool. Requests up to kMaxPooledSize are rounded up to a power of
+    * two (minimum kMinClassSize) and served from a per-class free list; chunks for a
+    * class are carved out of upstream blocks. Larger requests go straight upstream.
+    * Freed memory is recycled within its class and only returned upstream by
+    * release() or the destructor. Not thread safe, use one per thread.
+    */
+    class pool_resource : public memory_resource
+    {
+    public:
+        static const size_t kMinClassSize  = 16;
+        static const size_t kMaxPooledSize = 4096;
+        static const size_t kClassCount    = 9; // 16, 32, ..., 4096
+
+        explicit pool_resource(size_t block_size = 64 * 1024, memory_resource* upstream = NULL)
+            : upstream_(upstream ? upstream : get_default_resource())
+            , block_size_(block_size < 2 * kMaxPooledSize ? 2 * kMaxPooledSize : block_size)
+            , blocks_(NULL)
+            , bytes_in_use_(0), bytes_requested_(0), bytes_reserved_(0)
+        {
+            for (size_t i = 0; i < kClassCount; ++i)
+            {
+                free_[i] = NULL;
+                cur_[i] = end_[i] = NULL;
+            }
+        }
+
+        ~pool_resource()
+        {
+            release();
+        }
+
+        //! \brief Give every block back to upstream. Outstanding pointers become invalid.
+        void release()
+        {
+            while (blocks_)
+            {
+                Block* next = blocks_->next;
+                upstream_->deallocate(blocks_, blocks_->size);
+                blocks_ = next;
+            }
+            for (size_t i = 0; i < kClassCount; ++i)
+            {
+                free_[i] = NULL;
+                cur_[i] = end_[i] = NULL;
+            }
+            bytes_in_use_ = bytes_requested_ = bytes_reserved_ = 0;
+        }
+
+        //! \brief Bytes held by live allocations, after size-class rounding
+        size_t bytes_in_use() const { return bytes_in_use_; }
+
+        //! \brief Bytes live callers actually asked for. in_use - requested is internal fragmentation.
+        size_t bytes_requested() const { return bytes_requested_; }
+
+        //! \brief Bytes obtained from upstream for the size classes
+        size_t bytes_reserved() const { return bytes_reserved_; }
+
+    protected:
+        virtual void* do_allocate(size_t bytes, size_t alignment)
+        {
+            if (bytes > kMaxPooledSize || alignment > kMinClassSize)
+            {
+                return upstream_->allocate(bytes, alignment);
+            }
+
+            size_t index = class_index(bytes);
+            size_t size = kMinClassSize << index;
+            bytes_in_use_ += size;
+            bytes_requested_ += bytes;
+
+            if (free_[index])
+            {
+                FreeNode* n = free_[index];
+                free_[index] = n->next;
+                return n;
+            }
+
+            if (!cur_[index] || cur_[index] + size > end_[index])
+            {
+                refill(index);
+            }
+            void* p = cur_[index];
+            cur_[index] += size;
+            return p;
+        }
+
+        virtual void do_deallocate(void* p, size_t bytes, size_t alignment)
+        {
+            if (bytes > kMaxPooledSize || alignment > kMinClassSize)
+            {
+                upstream_->deallocate(p, bytes, alignment);
+                return;
+            }
+
+            size_t index = class_index(bytes);
+            bytes_in_use_ -= kMinClassSize << index;
+            bytes_requested_ -= bytes;
+
+            FreeNode* n = static_cast<FreeNode*>(p);
+            n->next = free_[index];
+            free_[index] = n;
+        }
+
+    private:
+        struct FreeNode
+        {
+            FreeNode* next;
+        };
+
+        struct Block
+        {
+            Block* next;
+            size_t size;
+            size_t padding_; // keep the payload kMinClassSize aligned
+        };
+
+        static size_t class_index(size_t bytes)
+        {
+            size_t index = 0;
+            size_t size = kMinClassSize;
+            while (size < bytes)
+            {
+                size <<= 1;
+                ++index;
+            }
+            return index;
+        }
+
+        void refill(size_t index)
+        {
+            size_t size = block_size_;
+            Block* b = static_cast<Block*>(upstream_->allocate(size));
+            b->next = blocks_;
+            b->size = size;
+            blocks_ = b;
+            cur_[index] = reinterpret_cast<char*>(b) + detail::align_up(sizeof(Block), kMinClassSize);
+            end_[index] = reinterpret_cast<char*>(b) + size;
+            bytes_reserved_ += size;
+        }
+
+    private:
+        memory_resource* upstream_;
+        size_t    block_size_;
+        Block*    blocks_;
+        FreeNode* free_[kClassCount];
+        char*     cur_[kClassCount];
+        char*     end_[kClassCount];
+        size_t    bytes_in_use_;
+        size_t    bytes_requested_;
+        size_t    bytes_reserved_;
+
+        pool_resource(const pool_resource&);
+        pool_resource& operator=(const pool_resource&);
+    };
+}
+
+#endif //QIHOO_MEMORY_RESOURCE_H_
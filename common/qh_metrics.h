@@ -0,0 +1,446 @@
+#ifndef QIHOO_METRICS_H_
+#define QIHOO_METRICS_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#ifdef QH_ENABLE_METRICS
+#include <time.h>
+#include <atomic>
+#include <mutex>
+#endif
+
+/**
+* Counters and latency histograms for the hot paths of the qh modules.
+*
+* Build with -DQH_ENABLE_METRICS (make METRICS=1) to turn them on. Without it
+* every class below is empty and every call an empty inline function, so the
+* instrumented code compiles to what it was before. All translation units of
+* a program have to agree on the switch.
+*
+* Metrics are objects with static storage duration:
+*   static qh::metrics::Counter g_hits("proxy_url.extract.hits");
+*   static qh::metrics::Histogram g_latency("proxy_url.extract.ns");
+*   ...
+*   qh::metrics::ScopedTimer timer(g_latency);
+*   g_hits.Add();
+*
+* Each thread records into its own slot with plain relaxed stores, nothing
+* is shared on the recording path. TakeSnapshot() sums up the slots of all
+* threads, including those that have exited.
+*
+* Histograms are HDR style: values below 8 have a bucket each, above that
+* every power of two is split into 8 linear buckets, so a bucket's bounds
+* are within 12.5% of each other over the whole 64 bit range.
+*/
+
+namespace qh
+{
+namespace metrics
+{
+    const size_t kMaxCounters = 64;
+    const size_t kMaxHistograms = 16;
+    const size_t kSubBucketBits = 3;
+    const size_t kSubBuckets = static_cast<size_t>(1) << kSubBucketBits;
+    const size_t kBuckets = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+    //! \brief The histogram bucket of value
+    inline size_t BucketOf(uint64_t value)
+    {
+        if (value < kSubBuckets)
+        {
+            return static_cast<size_t>(value);
+        }
+        size_t exponent = 63 - __builtin_clzll(value);
+        size_t sub = static_cast<size_t>(value >> (exponent - kSubBucketBits)) & (kSubBuckets - 1);
+        return (exponent - kSubBucketBits + 1) * kSubBuckets + sub;
+    }
+
+    //! \brief The smallest value that falls into bucket
+    inline uint64_t BucketLowerBound(size_t bucket)
+    {
+        if (bucket < kSubBuckets)
+        {
+            return bucket;
+        }
+        size_t exponent = bucket / kSubBuckets + kSubBucketBits - 1;
+        uint64_t sub = bucket % kSubBuckets;
+        return (static_cast<uint64_t>(1) << exponent) | (sub << (exponent - kSubBucketBits));
+    }
+
+    struct HistogramSnapshot
+    {
+        std::string             name;
+        uint64_t                count;
+        uint64_t                sum;
+        std::vector<uint64_t>   buckets;    //! kBuckets entries, empty if nothing was recorded
+
+        //! \brief Lower bound of the bucket holding the given fraction (0..1) of the values
+        uint64_t Percentile(double fraction) const
+        {
+            if (count == 0)
+            {
+                return 0;
+            }
+            uint64_t rank = static_cast<uint64_t>(fraction * (count - 1));
+            uint64_t seen = 0;
+            for (size_t i = 0; i < buckets.size(); ++i)
+            {
+                seen += buckets[i];
+                if (seen > rank)
+                {
+                    return BucketLowerBound(i);
+                }
+            }
+            return BucketLowerBound(buckets.size() - 1);
+        }
+
+        double Mean() const
+        {
+            return count ? static_cast<double>(sum) / count : 0.0;
+        }
+    };
+
+    struct Snapshot
+    {
+        std::vector<std::pair<std::string, uint64_t> >  counters;
+        std::vector<HistogramSnapshot>                  histograms;
+
+        //! \return - uint64_t - the counter's value, 0 if there is no such counter
+        uint64_t Counter(const std::string& name) const
+        {
+            for (size_t i = 0; i < counters.size(); ++i)
+            {
+                if (counters[i].first == name)
+                {
+                    return counters[i].second;
+                }
+            }
+            return 0;
+        }
+
+        //! \return - const HistogramSnapshot * - NULL if there is no such histogram
+        const HistogramSnapshot* Histogram(const std::string& name) const
+        {
+            for (size_t i = 0; i < histograms.size(); ++i)
+            {
+                if (histograms[i].name == name)
+                {
+                    return &histograms[i];
+                }
+            }
+            return NULL;
+        }
+
+        //! \brief One line per metric, "name value" or "name count=.. mean=.. p50=.. p99=.. max=.."
+        void Dump(FILE* out) const
+        {
+            for (size_t i = 0; i < counters.size(); ++i)
+            {
+                fprintf(out, "%s %llu\n", counters[i].first.c_str(), static_cast<unsigned long long>(counters[i].second));
+            }
+            for (size_t i = 0; i < histograms.size(); ++i)
+            {
+                const HistogramSnapshot& h = histograms[i];
+                fprintf(out, "%s count=%llu mean=%.1f p50=%llu p90=%llu p99=%llu max=%llu\n", h.name.c_str(),
+                    static_cast<unsigned long long>(h.count), h.Mean(),
+                    static_cast<unsigned long long>(h.Percentile(0.5)),
+                    static_cast<unsigned long long>(h.Percentile(0.9)),
+                    static_cast<unsigned long long>(h.Percentile(0.99)),
+                    static_cast<unsigned long long>(h.Percentile(1.0)));
+            }
+        }
+    };
+
+#ifdef QH_ENABLE_METRICS
+
+    namespace detail
+    {
+        // What one thread recorded. Only the owner writes, snapshots read.
+        struct Slot
+        {
+            std::atomic<uint64_t> counters[kMaxCounters];
+            std::atomic<uint64_t> sums[kMaxHistograms];
+            std::atomic<uint64_t> buckets[kMaxHistograms][kBuckets];
+
+            Slot()
+            {
+                for (size_t i = 0; i < kMaxCounters; ++i)
+                {
+                    counters[i].store(0, std::memory_order_relaxed);
+                }
+                for (size_t h = 0; h < kMaxHistograms; ++h)
+                {
+                    sums[h].store(0, std::memory_order_relaxed);
+                    for (size_t b = 0; b < kBuckets; ++b)
+                    {
+                        buckets[h][b].store(0, std::memory_order_relaxed);
+                    }
+                }
+            }
+        };
+
+        inline void Bump(std::atomic<uint64_t>& value, uint64_t n)
+        {
+            // single writer, a load and a store are enough
+            value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+
+        class Registry
+        {
+        public:
+            static Registry& Instance()
+            {
+                // never destroyed, threads may record while static objects go away
+                static Registry* registry = new Registry;
+                return *registry;
+            }
+
+            size_t AddCounter(const char* name)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (counter_names_.size() == kMaxCounters)
+                {
+                    return kMaxCounters;
+                }
+                counter_names_.push_back(name);
+                return counter_names_.size() - 1;
+            }
+
+            size_t AddHistogram(const char* name)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (histogram_names_.size() == kMaxHistograms)
+                {
+                    return kMaxHistograms;
+                }
+                histogram_names_.push_back(name);
+                return histogram_names_.size() - 1;
+            }
+
+            void AddSlot(Slot* slot)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                slots_.push_back(slot);
+            }
+
+            //! \brief Fold the slot of an exiting thread into the retired totals
+            void RetireSlot(Slot* slot)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                Accumulate(*slot, &retired_);
+                for (size_t i = 0; i < slots_.size(); ++i)
+                {
+                    if (slots_[i] == slot)
+                    {
+                        slots_.erase(slots_.begin() + i);
+                        break;
+                    }
+                }
+            }
+
+            Snapshot Take()
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                Slot* total = new Slot;
+                Accumulate(retired_, total);
+                for (size_t i = 0; i < slots_.size(); ++i)
+                {
+                    Accumulate(*slots_[i], total);
+                }
+
+                Snapshot snapshot;
+                for (size_t i = 0; i < counter_names_.size(); ++i)
+                {
+                    snapshot.counters.push_back(std::make_pair(counter_names_[i], total->counters[i].load(std::memory_order_relaxed)));
+                }
+                for (size_t h = 0; h < histogram_names_.size(); ++h)
+                {
+                    HistogramSnapshot hs;
+                    hs.name = histogram_names_[h];
+                    hs.count = 0;
+                    hs.sum = total->sums[h].load(std::memory_order_relaxed);
+                    hs.buckets.resize(kBuckets);
+                    for (size_t b = 0; b < kBuckets; ++b)
+                    {
+                        hs.buckets[b] = total->buckets[h][b].load(std::memory_order_relaxed);
+                        hs.count += hs.buckets[b];
+                    }
+                    if (hs.count == 0)
+                    {
+                        hs.buckets.clear();
+                    }
+                    snapshot.histograms.push_back(hs);
+                }
+                delete total;
+                return snapshot;
+            }
+
+        private:
+            static void Accumulate(const Slot& from, Slot* to)
+            {
+                for (size_t i = 0; i < kMaxCounters; ++i)
+                {
+                    Bump(to->counters[i], from.counters[i].load(std::memory_order_relaxed));
+                }
+                for (size_t h = 0; h < kMaxHistograms; ++h)
+                {
+                    Bump(to->sums[h], from.sums[h].load(std::memory_order_relaxed));
+                    for (size_t b = 0; b < kBuckets; ++b)
+                    {
+                        Bump(to->buckets[h][b], from.buckets[h][b].load(std::memory_order_relaxed));
+                    }
+                }
+            }
+
+        private:
+            std::mutex                  mutex_;
+            std::vector<const char*>    counter_names_;
+            std::vector<const char*>    histogram_names_;
+            std::vector<Slot*>          slots_;
+            Slot                        retired_;
+        };
+
+        // Registers the calling thread's slot on first use and retires it at thread exit
+        class SlotOwner
+        {
+        public:
+            SlotOwner() : slot_(new Slot)
+            {
+                Registry::Instance().AddSlot(slot_);
+            }
+
+            ~SlotOwner()
+            {
+                Registry::Instance().RetireSlot(slot_);
+                delete slot_;
+            }
+
+            Slot* slot() const { return slot_; }
+
+        private:
+            Slot* slot_;
+        };
+
+        inline Slot* LocalSlot()
+        {
+            static thread_local SlotOwner owner;
+            return owner.slot();
+        }
+
+        inline uint64_t NowNanos()
+        {
+            struct timespec ts;
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+        }
+    }
+
+    //! A monotonically growing count. Beyond kMaxCounters counters are dropped.
+    class Counter
+    {
+    public:
+        explicit Counter(const char* name) : id_(detail::Registry::Instance().AddCounter(name)) {}
+
+        void Add(uint64_t n = 1)
+        {
+            if (id_ < kMaxCounters)
+            {
+                detail::Bump(detail::LocalSlot()->counters[id_], n);
+            }
+        }
+
+    private:
+        size_t id_;
+    };
+
+    //! A distribution of values, usually nanoseconds. Beyond kMaxHistograms histograms are dropped.
+    class Histogram
+    {
+    public:
+        explicit Histogram(const char* name) : id_(detail::Registry::Instance().AddHistogram(name)) {}
+
+        void Record(uint64_t value)
+        {
+            if (id_ < kMaxHistograms)
+            {
+                detail::Slot* slot = detail::LocalSlot();
+                detail::Bump(slot->sums[id_], value);
+                detail::Bump(slot->buckets[id_][BucketOf(value)], 1);
+            }
+        }
+
+    private:
+        size_t id_;
+    };
+
+    //! Records the nanoseconds between its construction and destruction
+    class ScopedTimer
+    {
+    public:
+        explicit ScopedTimer(Histogram& histogram) : histogram_(histogram), begin_(detail::NowNanos()) {}
+
+        ~ScopedTimer()
+        {
+            histogram_.Record(detail::NowNanos() - begin_);
+        }
+
+    private:
+        Histogram&  histogram_;
+        uint64_t    begin_;
+
+        ScopedTimer(const ScopedTimer&);
+        ScopedTimer& operator=(const ScopedTimer&);
+    };
+
+    //! \brief Sum of what every thread recorded so far
+    inline Snapshot TakeSnapshot()
+    {
+        return detail::Registry::Instance().Take();
+    }
+
+    inline bool Enabled()
+    {
+        return true;
+    }
+
+#else // QH_ENABLE_METRICS
+
+    class Counter
+    {
+    public:
+        // constexpr: static counters need no initialization guard
+        explicit constexpr Counter(const char*) {}
+        void Add(uint64_t = 1) {}
+    };
+
+    class Histogram
+    {
+    public:
+        explicit constexpr Histogram(const char*) {}
+        void Record(uint64_t) {}
+    };
+
+    class ScopedTimer
+    {
+    public:
+        explicit ScopedTimer(Histogram&) {}
+    };
+
+    inline Snapshot TakeSnapshot()
+    {
+        return Snapshot();
+    }
+
+    inline bool Enabled()
+    {
+        return false;
+    }
+
+#endif // QH_ENABLE_METRICS
+}
+}
+
+#endif //QIHOO_METRICS_H_
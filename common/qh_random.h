@@ -0,0 +1,52 @@
+#ifndef QIHOO_RANDOM_H_
+#define QIHOO_RANDOM_H_
+
+#include <stdint.h>
+
+namespace qh
+{
+    //! The seed datasets are built from unless told otherwise
+    const uint64_t kDefaultRandomSeed = 20140106;
+
+    /**
+    * splitmix64: small, fast and the same sequence on every platform, which
+    * rand() does not promise. Datasets of the benchmarks and the workload
+    * generator are built from it, so a seed names a dataset.
+    */
+    class Random
+    {
+    public:
+        explicit Random(uint64_t seed) : state_(seed) {}
+
+        uint64_t Next()
+        {
+            uint64_t z = (state_ += 0x9e3779b97f4a7c15ULL);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            return z ^ (z >> 31);
+        }
+
+        //! \brief Uniform in [0, n), n > 0
+        uint32_t Uniform(uint32_t n)
+        {
+            return static_cast<uint32_t>(((Next() >> 32) * n) >> 32);
+        }
+
+        //! \brief Uniform in [lo, hi]
+        int Range(int lo, int hi)
+        {
+            return lo + static_cast<int>(Uniform(static_cast<uint32_t>(hi - lo) + 1));
+        }
+
+        //! \brief true with probability p
+        bool Chance(double p)
+        {
+            return (Next() >> 11) * (1.0 / 9007199254740992.0) < p;
+        }
+
+    private:
+        uint64_t state_;
+    };
+}
+
+#endif //QIHOO_RANDOM_H_
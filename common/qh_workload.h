@@ -0,0 +1,464 @@
+#ifndef QIHOO_WORKLOAD_H_
+#define QIHOO_WORKLOAD_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "qh_random.h"
+
+/**
+* Seeded generators of proxy URLs and INI files shaped like production data,
+* for the tests and benchmarks of proxy_url and ini_parser and for the
+* gen_workload tool. The same options and seed always give the same corpus.
+*
+* Every generated item comes with its ground truth: the sub url
+* ProxyURLExtractor::Extract has to find in a URL, the section, key and
+* value INIParser::Get has to return for an INI file.
+*/
+
+namespace qh
+{
+namespace workload
+{
+    struct UrlOptions
+    {
+        UrlOptions()
+            : hit_rate(0.5), min_params(1), max_params(16)
+            , min_value_len(1), max_value_len(32)
+            , percent_rate(0.05), decoy_rate(0.1), max_nesting(2)
+        {
+        }
+
+        std::vector<std::string> keys;  //! proxy keys, DefaultKeys() if empty
+        double  hit_rate;       //! fraction of URLs carrying a proxy key with a value
+        size_t  min_params;     //! parameters per query, the proxy key included
+        size_t  max_params;
+        size_t  min_value_len;  //! length of the values of ordinary parameters
+        size_t  max_value_len;
+        double  percent_rate;   //! fraction of value characters written as %XX
+        double  decoy_rate;     //! chance per parameter of a near miss: "url=", "url" or "uurl=..."
+        size_t  max_nesting;    //! a proxied URL is itself a proxy URL up to this depth
+    };
+
+    struct UrlSample
+    {
+        std::string url;
+        std::string expected;   //! what Extract must return, empty for a miss
+    };
+
+    //! \brief The keys of the proxy_url unit tests
+    inline std::vector<std::string> DefaultKeys()
+    {
+        static const char* const kKeys[] = {"a", "u", "url", "curl", "query", "uri"};
+        return std::vector<std::string>(kKeys, kKeys + sizeof(kKeys) / sizeof(kKeys[0]));
+    }
+
+    struct IniOptions
+    {
+        IniOptions()
+            : sections(10), keys_per_section(100), global_keys(0), max_depth(1)
+            , min_key_len(3), max_key_len(16), min_value_len(0), max_value_len(64)
+            , line_separator("\n"), key_value_separator("=")
+            , comment_rate(0.05), blank_rate(0.05), padding_rate(0.2)
+            , key_vocabulary(0), value_vocabulary(0)
+        {
+        }
+
+        size_t  sections;
+        size_t  keys_per_section;
+        size_t  global_keys;    //! keys before the first section header
+        size_t  max_depth;      //! section names have 1 to max_depth dotted parts
+        size_t  min_key_len;
+        size_t  max_key_len;
+        size_t  min_value_len;
+        size_t  max_value_len;
+        // Keys are [a-z0-9_], values and comments [A-Za-z0-9_.:/ -] plus the
+        // key value separator, so separators must be made of other characters.
+        // INIParser trims lines, a separator must not start or end with blanks.
+        std::string line_separator;
+        std::string key_value_separator;
+        double  comment_rate;   //! chance of a comment line before an entry
+        double  blank_rate;     //! chance of an empty line before an entry
+        double  padding_rate;   //! chance of blanks around key, separator and value
+        // Real configs repeat themselves. With a vocabulary every section uses
+        // the same key names in the same order and values are drawn from a
+        // fixed set, 0 draws every key and value afresh.
+        size_t  key_vocabulary;
+        size_t  value_vocabulary;
+    };
+
+    struct IniEntry
+    {
+        std::string section;    //! "" for the global keys
+        std::string key;
+        std::string value;
+    };
+
+    namespace detail
+    {
+        const char kLower[] = "abcdefghijklmnopqrstuvwxyz";
+        const char kAlnum[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+        const char kHex[] = "0123456789ABCDEF";
+
+        inline size_t Length(Random& rng, size_t lo, size_t hi)
+        {
+            return hi <= lo ? lo : lo + rng.Uniform(static_cast<uint32_t>(hi - lo + 1));
+        }
+
+        template<size_t N>
+        inline void AppendFrom(Random& rng, const char (&chars)[N], size_t len, std::string* out)
+        {
+            for (size_t i = 0; i < len; ++i)
+            {
+                out->push_back(chars[rng.Uniform(N - 1)]);
+            }
+        }
+
+        inline bool Contains(const std::vector<std::string>& v, const std::string& s)
+        {
+            for (size_t i = 0; i < v.size(); ++i)
+            {
+                if (v[i] == s)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        const char kIniValueChars[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_.:/ -";
+
+        inline std::string IniKey(Random& rng, const IniOptions& options, size_t index)
+        {
+            std::string key;
+            size_t len = Length(rng, options.min_key_len, options.max_key_len);
+            AppendFrom(rng, kLower, len ? len : 1, &key);
+            char suffix[32];
+            snprintf(suffix, sizeof(suffix), "_%zu", index);
+            return key + suffix;
+        }
+
+        //! \brief A value as INIParser returns it: trimmed
+        inline std::string IniValue(Random& rng, const IniOptions& options)
+        {
+            std::string value;
+            size_t len = Length(rng, options.min_value_len, options.max_value_len);
+            for (size_t i = 0; i < len; ++i)
+            {
+                if (rng.Chance(0.02))
+                {
+                    value += options.key_value_separator;
+                }
+                else
+                {
+                    value.push_back(kIniValueChars[rng.Uniform(sizeof(kIniValueChars) - 1)]);
+                }
+            }
+            size_t first = value.find_first_not_of(' ');
+            return first == std::string::npos ? std::string() : value.substr(first, value.find_last_not_of(' ') - first + 1);
+        }
+
+        //! \brief Escape what would end or split a parameter, as a browser does
+        inline void AppendEncoded(const std::string& s, std::string* out)
+        {
+            for (size_t i = 0; i < s.size(); ++i)
+            {
+                char c = s[i];
+                if (c == '%' || c == '&' || c == '=' || c == '?' || c == '#')
+                {
+                    out->push_back('%');
+                    out->push_back(kHex[static_cast<unsigned char>(c) >> 4]);
+                    out->push_back(kHex[c & 0xf]);
+                }
+                else
+                {
+                    out->push_back(c);
+                }
+            }
+        }
+    }
+
+    //! Streams URLs, for corpora too large to hold
+    class UrlGenerator
+    {
+    public:
+        UrlGenerator(const UrlOptions& options, uint64_t seed)
+            : options_(options), rng_(seed)
+        {
+            if (options_.keys.empty())
+            {
+                options_.keys = DefaultKeys();
+            }
+            if (options_.max_params < options_.min_params)
+            {
+                options_.max_params = options_.min_params;
+            }
+        }
+
+        UrlSample Next()
+        {
+            UrlSample sample;
+            bool hit = rng_.Chance(options_.hit_rate);
+            sample.url = Url(hit, detail::Length(rng_, 1, options_.max_nesting), &sample.expected);
+            return sample;
+        }
+
+    private:
+        //! \brief A URL whose first proxy parameter with a value is a URL nested depth - 1 deep
+        std::string Url(bool hit, size_t depth, std::string* expected)
+        {
+            std::string url = rng_.Chance(0.7) ? "http://" : "https://";
+            AppendHost(&url);
+            AppendPath(&url);
+
+            size_t params = detail::Length(rng_, options_.min_params, options_.max_params);
+            if (params == 0)
+            {
+                return url;
+            }
+            size_t target = hit ? rng_.Uniform(static_cast<uint32_t>(params)) : params;
+            url.push_back('?');
+            for (size_t i = 0; i < params; ++i)
+            {
+                if (i)
+                {
+                    url.push_back('&');
+                }
+                if (i == target)
+                {
+                    std::string inner = depth > 1 ? Url(true, depth - 1, NULL) : Url(false, 1, NULL);
+                    std::string value;
+                    detail::AppendEncoded(inner, &value);
+                    url += Key();
+                    url.push_back('=');
+                    url += value;
+                    if (expected)
+                    {
+                        *expected = value;
+                    }
+                }
+                else if (rng_.Chance(options_.decoy_rate))
+                {
+                    AppendDecoy(&url);
+                }
+                else
+                {
+                    AppendName(&url);
+                    url.push_back('=');
+                    AppendValue(&url);
+                }
+            }
+            return url;
+        }
+
+        const std::string& Key()
+        {
+            return options_.keys[rng_.Uniform(static_cast<uint32_t>(options_.keys.size()))];
+        }
+
+        void AppendHost(std::string* url)
+        {
+            static const char* const kTlds[] = {"com", "cn", "net", "org", "com.cn", "edu.cn"};
+            size_t labels = detail::Length(rng_, 2, 3);
+            for (size_t i = 1; i < labels; ++i)
+            {
+                detail::AppendFrom(rng_, detail::kLower, detail::Length(rng_, 2, 12), url);
+                url->push_back('.');
+            }
+            *url += kTlds[rng_.Uniform(sizeof(kTlds) / sizeof(kTlds[0]))];
+        }
+
+        void AppendPath(std::string* url)
+        {
+            static const char* const kExts[] = {".php", ".jsp", ".aspx", ".html", ""};
+            size_t segments = detail::Length(rng_, 0, 4);
+            for (size_t i = 0; i < segments; ++i)
+            {
+                url->push_back('/');
+                detail::AppendFrom(rng_, detail::kAlnum, detail::Length(rng_, 1, 12), url);
+            }
+            url->push_back('/');
+            if (rng_.Chance(0.5))
+            {
+                detail::AppendFrom(rng_, detail::kLower, detail::Length(rng_, 1, 10), url);
+                *url += kExts[rng_.Uniform(sizeof(kExts) / sizeof(kExts[0]))];
+            }
+        }
+
+        //! \brief A parameter name that is not a proxy key
+        void AppendName(std::string* url)
+        {
+            std::string name;
+            do
+            {
+                name.clear();
+                detail::AppendFrom(rng_, detail::kLower, detail::Length(rng_, 1, 10), &name);
+            } while (detail::Contains(options_.keys, name));
+            *url += name;
+        }
+
+        void AppendValue(std::string* url)
+        {
+            static const char kChars[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-_.~";
+            size_t len = detail::Length(rng_, options_.min_value_len, options_.max_value_len);
+            for (size_t i = 0; i < len; ++i)
+            {
+                if (rng_.Chance(options_.percent_rate))
+                {
+                    url->push_back('%');
+                    url->push_back(detail::kHex[rng_.Uniform(16)]);
+                    url->push_back(detail::kHex[rng_.Uniform(16)]);
+                }
+                else
+                {
+                    url->push_back(kChars[rng_.Uniform(sizeof(kChars) - 1)]);
+                }
+            }
+        }
+
+        //! \brief Something that looks like a proxy parameter but must not match
+        void AppendDecoy(std::string* url)
+        {
+            const std::string& key = Key();
+            switch (rng_.Uniform(3))
+            {
+            case 0:     // a key without a value
+                *url += key;
+                url->push_back('=');
+                break;
+            case 1:     // a key without '='
+                *url += key;
+                break;
+            default:    // a longer name the key is a prefix of
+                {
+                    std::string name = key;
+                    do
+                    {
+                        detail::AppendFrom(rng_, detail::kLower, 1, &name);
+                    } while (detail::Contains(options_.keys, name));
+                    *url += name;
+                }
+                url->push_back('=');
+                AppendValue(url);
+                break;
+            }
+        }
+
+    private:
+        UrlOptions  options_;
+        Random      rng_;
+    };
+
+    //! \brief count URLs with their ground truth
+    inline std::vector<UrlSample> GenerateUrls(const UrlOptions& options, size_t count, uint64_t seed)
+    {
+        UrlGenerator generator(options, seed);
+        std::vector<UrlSample> samples;
+        samples.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            samples.push_back(generator.Next());
+        }
+        return samples;
+    }
+
+    //! \brief An INI file of options.sections sections of options.keys_per_section keys each
+    //! \param[out] - entries - if not NULL, every key of the file in file order
+    inline std::string GenerateIni(const IniOptions& options, uint64_t seed, std::vector<IniEntry>* entries = NULL)
+    {
+        Random rng(seed);
+        std::string out;
+        char suffix[32];
+
+        std::vector<std::string> key_vocabulary;
+        for (size_t i = 0; i < options.key_vocabulary; ++i)
+        {
+            key_vocabulary.push_back(detail::IniKey(rng, options, i));
+        }
+        static const char* const kCommonValues[] = {"0", "1", "true", "false", "yes", "no", "on", "off"};
+        std::vector<std::string> value_vocabulary;
+        for (size_t i = 0; i < options.value_vocabulary; ++i)
+        {
+            const size_t common = sizeof(kCommonValues) / sizeof(kCommonValues[0]);
+            value_vocabulary.push_back(i < common ? std::string(kCommonValues[i]) : detail::IniValue(rng, options));
+        }
+
+        for (size_t s = 0; s <= options.sections; ++s)
+        {
+            // s == 0 holds the global keys
+            std::string section;
+            size_t keys = options.global_keys;
+            if (s > 0)
+            {
+                size_t depth = detail::Length(rng, 1, options.max_depth ? options.max_depth : 1);
+                for (size_t d = 0; d < depth; ++d)
+                {
+                    if (d)
+                    {
+                        section.push_back('.');
+                    }
+                    detail::AppendFrom(rng, detail::kLower, detail::Length(rng, 2, 10), &section);
+                }
+                // the index keeps names unique
+                snprintf(suffix, sizeof(suffix), "%zu", s);
+                section += suffix;
+                out += rng.Chance(options.padding_rate) ? "[ " : "[";
+                out += section;
+                out += rng.Chance(options.padding_rate) ? " ]" : "]";
+                out += options.line_separator;
+                keys = options.keys_per_section;
+            }
+
+            for (size_t k = 0; k < keys; ++k)
+            {
+                if (rng.Chance(options.comment_rate))
+                {
+                    out += rng.Chance(0.5) ? "; " : "# ";
+                    detail::AppendFrom(rng, detail::kIniValueChars, detail::Length(rng, 0, 40), &out);
+                    out += options.line_separator;
+                }
+                if (rng.Chance(options.blank_rate))
+                {
+                    out += options.line_separator;
+                }
+
+                IniEntry entry;
+                entry.section = section;
+                if (key_vocabulary.empty())
+                {
+                    entry.key = detail::IniKey(rng, options, k);
+                }
+                else
+                {
+                    // the words end in their index, a second suffix keeps longer sections unique
+                    entry.key = key_vocabulary[k % key_vocabulary.size()];
+                    if (k >= key_vocabulary.size())
+                    {
+                        snprintf(suffix, sizeof(suffix), "_%zu", k / key_vocabulary.size());
+                        entry.key += suffix;
+                    }
+                }
+                entry.value = value_vocabulary.empty() ? detail::IniValue(rng, options)
+                    : value_vocabulary[rng.Uniform(static_cast<uint32_t>(value_vocabulary.size()))];
+
+                bool padded = rng.Chance(options.padding_rate);
+                out += entry.key;
+                out += padded ? " " : "";
+                out += options.key_value_separator;
+                out += padded ? " " : "";
+                out += entry.value;
+                out += options.line_separator;
+                if (entries)
+                {
+                    entries->push_back(entry);
+                }
+            }
+        }
+        return out;
+    }
+}
+}
+
+#endif //QIHOO_WORKLOAD_H_
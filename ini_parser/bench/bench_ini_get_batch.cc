@@ -0,0 +1,86 @@
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "qh_bench.h"
+#include "qh_workload.h"
+#include "ini_parser.h"
+
+namespace
+{
+    //! \brief Reads of batch keys of one section, the way a request handler
+    //!   reads its settings, one random section after another
+    void Run(const char* mode, qh::INIParser::Storage storage, const std::string& text,
+        const qh::workload::IniOptions& options, const std::vector<qh::workload::IniEntry>& entries, size_t batch)
+    {
+        qh::INIParser parser(storage);
+        parser.Parse(text.data(), text.size(), "\n", "=");
+
+        // entries holds every section's keys in a row
+        const size_t kBatches = 20000;
+        qh::bench::Random rng;
+        std::vector<std::string> sections;
+        std::vector<std::string> keys;
+        for (size_t b = 0; b < kBatches; ++b)
+        {
+            size_t s = rng.Uniform(static_cast<uint32_t>(options.sections));
+            size_t first = rng.Uniform(static_cast<uint32_t>(options.keys_per_section - batch + 1));
+            const qh::workload::IniEntry* e = &entries[s * options.keys_per_section + first];
+            sections.push_back(e->section);
+            for (size_t k = 0; k < batch; ++k)
+            {
+                keys.push_back(e[k].key);
+            }
+        }
+
+        char name[96];
+        size_t hits = 0;
+        snprintf(name, sizeof(name), "INIParser::Get x%zu %s/entries=%zu", batch, mode, entries.size());
+        qh::bench::Run(name, kBatches * batch, [&]() {
+            for (size_t b = 0; b < kBatches; ++b)
+            {
+                for (size_t k = 0; k < batch; ++k)
+                {
+                    bool found = false;
+                    parser.Get(sections[b], keys[b * batch + k], &found);
+                    hits += found;
+                }
+            }
+        });
+
+        std::vector<const std::string*> values(batch);
+        snprintf(name, sizeof(name), "INIParser::GetBatch x%zu %s/entries=%zu", batch, mode, entries.size());
+        qh::bench::Run(name, kBatches * batch, [&]() {
+            for (size_t b = 0; b < kBatches; ++b)
+            {
+                hits += parser.GetBatch(sections[b], &keys[b * batch], batch, &values[0]);
+            }
+        });
+        if (hits != 2 * kBatches * batch)
+        {
+            fprintf(stderr, "%s: %zu hits, expected %zu\n", name, hits, 2 * kBatches * batch);
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    // 1M entries, too many for the caches; no global keys, so entries[]
+    // is sections * keys_per_section
+    qh::workload::IniOptions options;
+    options.sections = 10000;
+    options.keys_per_section = 100;
+    options.max_depth = 3;
+    options.key_vocabulary = 100;
+    options.value_vocabulary = 1000;
+    std::vector<qh::workload::IniEntry> entries;
+    std::string text = qh::workload::GenerateIni(options, qh::bench::Seed(), &entries);
+
+    const size_t batches[] = {20, 50};
+    for (size_t i = 0; i < sizeof(batches) / sizeof(batches[0]); ++i)
+    {
+        Run("strings", qh::INIParser::kStrings, text, options, entries, batches[i]);
+        Run("interned", qh::INIParser::kInterned, text, options, entries, batches[i]);
+    }
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <string>
+#include <vector>
+
+#include "qh_bench.h"
+#include "qh_workload.h"
+#include "ini_parser.h"
+
+namespace
+{
+    size_t ResidentBytes()
+    {
+        size_t pages = 0;
+        size_t resident = 0;
+        FILE* f = fopen("/proc/self/statm", "r");
+        if (!f)
+        {
+            return 0;
+        }
+        if (fscanf(f, "%zu %zu", &pages, &resident) != 2)
+        {
+            resident = 0;
+        }
+        fclose(f);
+        return resident * sysconf(_SC_PAGESIZE);
+    }
+
+    //! \brief Parses and queries in a child process, so that neither mode
+    //!   inherits the heap the other one grew
+    void Measure(const char* mode, qh::INIParser::Storage storage, const std::string& text,
+        const std::vector<qh::workload::IniEntry>& entries)
+    {
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid != 0)
+        {
+            int status = 0;
+            waitpid(pid, &status, 0);
+            return;
+        }
+
+        char name[64];
+        size_t before = ResidentBytes();
+        qh::INIParser* parser = new qh::INIParser(storage);
+        snprintf(name, sizeof(name), "INIParser::Parse %s/entries=%zu", mode, entries.size());
+        qh::bench::Run(name, entries.size(), [&]() {
+            parser->Parse(text.data(), text.size(), "\n", "=");
+        });
+        size_t rss = ResidentBytes() - before;
+        snprintf(name, sizeof(name), "INIParser memory %s/entries=%zu", mode, entries.size());
+        qh::bench::Report(name, "rss_bytes", static_cast<double>(rss));
+        qh::bench::Report(name, "bytes_per_entry", static_cast<double>(rss) / entries.size());
+
+        const size_t kGets = 1000000;
+        size_t hits = 0;
+        snprintf(name, sizeof(name), "INIParser::Get %s/entries=%zu", mode, entries.size());
+        qh::bench::Run(name, kGets, [&]() {
+            for (size_t g = 0; g < kGets; ++g)
+            {
+                const qh::workload::IniEntry& e = entries[(g * 7919) % entries.size()];
+                bool found = false;
+                parser->Get(e.section, e.key, &found);
+                hits += found;
+            }
+        });
+        qh::bench::DoNotOptimize(hits);
+        fflush(stdout);
+        _exit(hits == kGets ? 0 : 1);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    // a 1M entry config that repeats itself the way generated configs do:
+    // the same 100 key names in every section, values from a set of 1000
+    qh::workload::IniOptions options;
+    options.sections = 10000;
+    options.keys_per_section = 100;
+    options.max_depth = 3;
+    options.max_value_len = 48;
+    options.key_vocabulary = 100;
+    options.value_vocabulary = 1000;
+    std::vector<qh::workload::IniEntry> entries;
+    std::string text = qh::workload::GenerateIni(options, qh::bench::Seed(), &entries);
+
+    Measure("strings", qh::INIParser::kStrings, text, entries);
+    Measure("interned", qh::INIParser::kInterned, text, entries);
+    return 0;
+}
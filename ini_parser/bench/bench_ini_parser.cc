@@ -0,0 +1,78 @@
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "qh_bench.h"
+#include "qh_metrics.h"
+#include "qh_workload.h"
+#include "ini_parser.h"
+
+namespace
+{
+    // production shaped: comments, blank lines, padding, dotted section names
+    std::string MakeIni(size_t sections, size_t keys_per_section, std::vector<std::string>* lookups)
+    {
+        qh::workload::IniOptions options;
+        options.sections = sections;
+        options.keys_per_section = keys_per_section;
+        options.max_depth = 3;
+        std::vector<qh::workload::IniEntry> entries;
+        std::string text = qh::workload::GenerateIni(options, qh::bench::Seed(), &entries);
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            lookups->push_back(entries[i].section);
+            lookups->push_back(entries[i].key);
+        }
+        return text;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t sizes[][2] = {{1, 100}, {100, 100}, {1000, 1000}};
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i)
+    {
+        std::vector<std::string> lookups;
+        std::string text = MakeIni(sizes[i][0], sizes[i][1], &lookups);
+        size_t entries = lookups.size() / 2;
+        char name[64];
+
+        qh::INIParser* parser = NULL;
+        snprintf(name, sizeof(name), "INIParser::Parse/entries=%zu", entries);
+        double ns = qh::bench::Run(name, entries, [&]() {
+            parser = new qh::INIParser;
+            parser->Parse(text.data(), text.size(), "\n", "=");
+        });
+        qh::bench::Report(name, "MB/s", text.size() / (ns * entries) * 1e3);
+
+        const size_t kGets = 1000000;
+        size_t hits = 0;
+        snprintf(name, sizeof(name), "INIParser::Get hit/entries=%zu", entries);
+        qh::bench::Run(name, kGets, [&]() {
+            for (size_t g = 0; g < kGets; ++g)
+            {
+                size_t e = (g * 7919) % entries;
+                bool found = false;
+                parser->Get(lookups[2 * e], lookups[2 * e + 1], &found);
+                hits += found;
+            }
+        });
+
+        std::string missing = "no_such_key";
+        snprintf(name, sizeof(name), "INIParser::Get miss/entries=%zu", entries);
+        qh::bench::Run(name, kGets, [&]() {
+            for (size_t g = 0; g < kGets; ++g)
+            {
+                bool found = false;
+                parser->Get(lookups[2 * ((g * 7919) % entries)], missing, &found);
+                hits += found;
+            }
+        });
+        qh::bench::DoNotOptimize(hits);
+        delete parser;
+    }
+
+    // make bench METRICS=1: the recorded metrics go to stderr, stdout stays JSON
+    qh::metrics::TakeSnapshot().Dump(stderr);
+    return 0;
+}
@@ -1,7 +1,351 @@
 #include "ini_parser.h"
 
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include "qh_metrics.h"
 
 namespace qh
 {
+    namespace
+    {
+        const std::string kEmpty;
+
+        metrics::Histogram g_get_ns("ini_parser.get.ns");
+        metrics::Counter g_get_hits("ini_parser.get.hits");
+        metrics::Counter g_get_misses("ini_parser.get.misses");
+        metrics::Counter g_parse_bytes("ini_parser.parse.bytes_scanned");
+        metrics::Histogram g_get_batch_ns("ini_parser.get_batch.ns");
+
+        inline bool IsBlank(char c)
+        {
+            return c == ' ' || c == '\t' || c == '\r';
+        }
+
+        void Trim(const char** begin, const char** end)
+        {
+            while (*begin < *end && IsBlank(**begin))
+            {
+                ++*begin;
+            }
+            while (*end > *begin && IsBlank((*end)[-1]))
+            {
+                --*end;
+            }
+        }
+
+        //! \brief First occurrence of [pattern, pattern + len) in [begin, end), or end
+        const char* Find(const char* begin, const char* end, const char* pattern, size_t len)
+        {
+            if (len == 1)
+            {
+                const char* p = static_cast<const char*>(memchr(begin, *pattern, end - begin));
+                return p ? p : end;
+            }
+            return std::search(begin, end, pattern, pattern + len);
+        }
+    }
+
+    INIParser::INIParser( Storage storage )
+        : storage_(storage), used_slots_(0)
+    {
+    }
+
+    INIParser::~INIParser()
+    {
+    }
+
+    bool INIParser::Parse( const std::string& ini_file_path )
+    {
+        std::ifstream ifs(ini_file_path.c_str(), std::ios::in | std::ios::binary);
+        if (!ifs)
+        {
+            return false;
+        }
+
+        std::stringstream ss;
+        ss << ifs.rdbuf();
+        std::string data = ss.str();
+        return Parse(data.data(), data.size(), "\n", "=");
+    }
+
+    bool INIParser::Parse( const char* ini_data, size_t ini_data_len, const std::string& line_seperator, const std::string& key_value_seperator )
+    {
+        if (line_seperator.empty() || key_value_seperator.empty() || (!ini_data && ini_data_len))
+        {
+            return false;
+        }
+
+        g_parse_bytes.Add(ini_data_len);
+        std::string section;
+        const char* p = ini_data;
+        const char* end = ini_data + ini_data_len;
+        while (p < end)
+        {
+            const char* line_end = Find(p, end, line_seperator.data(), line_seperator.size());
+            if (!ParseLine(p, line_end, key_value_seperator, &section))
+            {
+                return false;
+            }
+            p = line_end == end ? end : line_end + line_seperator.size();
+        }
+        return true;
+    }
+
+    bool INIParser::ParseLine( const char* begin, const char* end, const std::string& key_value_seperator, std::string* section )
+    {
+        Trim(&begin, &end);
+        if (begin == end || *begin == ';' || *begin == '#')
+        {
+            return true;
+        }
+
+        if (*begin == '[')
+        {
+            if (end[-1] != ']')
+            {
+                return false;
+            }
+            const char* name = begin + 1;
+            const char* name_end = end - 1;
+            Trim(&name, &name_end);
+            section->assign(name, name_end);
+            return true;
+        }
+
+        const char* sep = Find(begin, end, key_value_seperator.data(), key_value_seperator.size());
+        if (sep == end)
+        {
+            return false;
+        }
+
+        const char* key_end = sep;
+        const char* value = sep + key_value_seperator.size();
+        Trim(&begin, &key_end);
+        Trim(&value, &end);
+        if (begin == key_end)
+        {
+            return false;
+        }
+        Store(*section, begin, key_end, value, end);
+        return true;
+    }
+
+    void INIParser::Store( const std::string& section, const char* key, const char* key_end, const char* value, const char* value_end )
+    {
+        if (storage_ == kStrings)
+        {
+            sections_[section][std::string(key, key_end)].assign(value, value_end);
+            return;
+        }
+
+        if ((used_slots_ + 1) * 10 > slots_.size() * 7)
+        {
+            Grow();
+        }
+        uint32_t section_id = pool_.Intern(section.data(), section.size());
+        uint32_t key_id = pool_.Intern(key, key_end - key);
+        size_t len = value_end - value;
+        uint32_t value_id = len <= kMaxInternedValue ? pool_.Intern(value, len) : pool_.Add(value, len);
+
+        Slot& slot = slots_[Probe(section_id, key_id, Home(section_id, key_id))];
+        if (slot.section == StringPool::kNoId)
+        {
+            slot.section = section_id;
+            slot.key = key_id;
+            ++used_slots_;
+        }
+        slot.value = value_id;
+    }
+
+    size_t INIParser::Home( uint32_t section_id, uint32_t key_id ) const
+    {
+        uint64_t h = ((static_cast<uint64_t>(section_id) << 32) | key_id) * 0x9e3779b97f4a7c15ULL;
+        return static_cast<size_t>(h ^ (h >> 32)) & (slots_.size() - 1);
+    }
+
+    size_t INIParser::Probe( uint32_t section_id, uint32_t key_id, size_t home ) const
+    {
+        size_t mask = slots_.size() - 1;
+        size_t i = home;
+        while (slots_[i].section != StringPool::kNoId &&
+            (slots_[i].section != section_id || slots_[i].key != key_id))
+        {
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+
+    void INIParser::Grow()
+    {
+        Slot free_slot = {StringPool::kNoId, StringPool::kNoId, StringPool::kNoId};
+        std::vector<Slot> old(slots_.empty() ? 16 : slots_.size() * 2, free_slot);
+        old.swap(slots_);
+        for (size_t i = 0; i < old.size(); ++i)
+        {
+            if (old[i].section != StringPool::kNoId)
+            {
+                slots_[Probe(old[i].section, old[i].key, Home(old[i].section, old[i].key))] = old[i];
+            }
+        }
+    }
+
+    const std::string& INIParser::Get( const std::string& key, bool* found )
+    {
+        return Get(kEmpty, key, found);
+    }
+
+    const std::string& INIParser::Get( const std::string& section, const std::string& key, bool* found )
+    {
+        metrics::ScopedTimer timer(g_get_ns);
+        if (storage_ == kInterned)
+        {
+            uint32_t section_id = pool_.Find(section.data(), section.size());
+            uint32_t key_id = pool_.Find(key.data(), key.size());
+            if (section_id != StringPool::kNoId && key_id != StringPool::kNoId && !slots_.empty())
+            {
+                const Slot& slot = slots_[Probe(section_id, key_id, Home(section_id, key_id))];
+                if (slot.section != StringPool::kNoId)
+                {
+                    if (found)
+                    {
+                        *found = true;
+                    }
+                    g_get_hits.Add();
+                    return pool_.Get(slot.value);
+                }
+            }
+            if (found)
+            {
+                *found = false;
+            }
+            g_get_misses.Add();
+            return kEmpty;
+        }
+
+        SectionMap::const_iterator s = sections_.find(section);
+        if (s != sections_.end())
+        {
+            KeyValueMap::const_iterator kv = s->second.find(key);
+            if (kv != s->second.end())
+            {
+                if (found)
+                {
+                    *found = true;
+                }
+                g_get_hits.Add();
+                return kv->second;
+            }
+        }
+
+        if (found)
+        {
+            *found = false;
+        }
+        g_get_misses.Add();
+        return kEmpty;
+    }
+
+    size_t INIParser::GetBatch( const std::string& section, const std::string* keys, size_t count, const std::string** values, bool* found )
+    {
+        metrics::ScopedTimer timer(g_get_batch_ns);
+        std::fill(values, values + count, &kEmpty);
+        if (found)
+        {
+            std::fill(found, found + count, false);
+        }
+
+        size_t hits = 0;
+        if (storage_ == kStrings)
+        {
+            SectionMap::const_iterator s = sections_.find(section);
+            const KeyValueMap* map = s != sections_.end() ? &s->second : NULL;
+            for (size_t begin = 0; map && begin < count; begin += kGetBatch)
+            {
+                size_t n = count - begin < kGetBatch ? count - begin : kGetBatch;
+                const std::string* batch = keys + begin;
+
+                // hash every key and prefetch the first entry of its bucket,
+                // then walk the buckets once those loads are under way
+                size_t buckets[kGetBatch];
+                for (size_t i = 0; i < n; ++i)
+                {
+                    buckets[i] = map->bucket(batch[i]);
+                    KeyValueMap::const_local_iterator first = map->begin(buckets[i]);
+                    if (first != map->end(buckets[i]))
+                    {
+                        __builtin_prefetch(&*first);
+                    }
+                }
+                for (size_t i = 0; i < n; ++i)
+                {
+                    KeyValueMap::const_local_iterator it = map->begin(buckets[i]);
+                    KeyValueMap::const_local_iterator end = map->end(buckets[i]);
+                    while (it != end && it->first != batch[i])
+                    {
+                        ++it;
+                    }
+                    if (it != end)
+                    {
+                        values[begin + i] = &it->second;
+                        if (found)
+                        {
+                            found[begin + i] = true;
+                        }
+                        ++hits;
+                    }
+                }
+            }
+        }
+        else if (!slots_.empty())
+        {
+            uint32_t section_id = pool_.Find(section.data(), section.size());
+            for (size_t begin = 0; section_id != StringPool::kNoId && begin < count; begin += kGetBatch)
+            {
+                size_t n = count - begin < kGetBatch ? count - begin : kGetBatch;
+                const std::string* batch = keys + begin;
 
-}
\ No newline at end of file
+                // every pass starts the loads the next one waits for
+                uint64_t hashes[kGetBatch];
+                for (size_t i = 0; i < n; ++i)
+                {
+                    hashes[i] = StringPool::Hash(batch[i].data(), batch[i].size());
+                    pool_.Prefetch(hashes[i]);
+                }
+                uint32_t key_ids[kGetBatch];
+                size_t homes[kGetBatch];
+                for (size_t i = 0; i < n; ++i)
+                {
+                    key_ids[i] = pool_.Find(batch[i].data(), batch[i].size(), hashes[i]);
+                    if (key_ids[i] != StringPool::kNoId)
+                    {
+                        homes[i] = Home(section_id, key_ids[i]);
+                        __builtin_prefetch(&slots_[homes[i]]);
+                    }
+                }
+                for (size_t i = 0; i < n; ++i)
+                {
+                    if (key_ids[i] == StringPool::kNoId)
+                    {
+                        continue;
+                    }
+                    const Slot& slot = slots_[Probe(section_id, key_ids[i], homes[i])];
+                    if (slot.section != StringPool::kNoId)
+                    {
+                        values[begin + i] = &pool_.Get(slot.value);
+                        if (found)
+                        {
+                            found[begin + i] = true;
+                        }
+                        ++hits;
+                    }
+                }
+            }
+        }
+        g_get_hits.Add(hits);
+        g_get_misses.Add(count - hits);
+        return hits;
+    }
+}
@@ -1,14 +1,44 @@
 #ifndef QIHOO_INI_PARSER_H_
 #define QIHOO_INI_PARSER_H_
 
+#include <stdint.h>
 #include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "string_pool.h"
 
 namespace qh
 {
+    /**
+    * Lines are split by line_seperator and every line by the first
+    * key_value_seperator. Keys and values are trimmed of blanks, tabs and '\r'.
+    * A "[name]" line starts section name, keys before the first section live
+    * in the default section "". Empty lines and lines starting with ';' or '#'
+    * are skipped. A later value for the same key replaces the earlier one.
+    *
+    * kInterned storage is for large generated configs that repeat the same
+    * key names in thousands of sections and the same short values over and
+    * over. Section names, keys and values up to kMaxInternedValue bytes are
+    * stored once in a StringPool, longer values once per entry, and every
+    * entry is three 32 bit ids in one open addressing table. A value that
+    * gets replaced stays in the pool until the parser dies. Get() returns
+    * references into the pool, as stable as those of kStrings.
+    */
     class INIParser
     {
     public:
-        INIParser();
+        enum Storage
+        {
+            kStrings,   //! a std::string per key and per value
+            kInterned,  //! a pool of unique strings and an id table
+        };
+
+        static const size_t kMaxInternedValue = 32;
+        static const size_t kGetBatch = 16;
+
+    public:
+        explicit INIParser(Storage storage = kStrings);
         ~INIParser();
 
         //! \brief һϵINIļ
@@ -36,7 +66,48 @@ namespace qh
 
         const std::string& Get(const std::string& section, const std::string& key, bool* found);
 
+        //! \brief Get(section, keys[i], ...) for every i < count with one section
+        //!   lookup. The keys are hashed kGetBatch at a time and their entries
+        //!   prefetched before any is compared, so that the cache misses overlap:
+        //!   the first entry of each bucket for kStrings, the slot for kInterned.
+        //! \param[out] - const std::string * * values - values[i] is what Get(section, keys[i], NULL) returns
+        //! \param[out] - bool * found - if not NULL, found[i] is true if keys[i] is there
+        //! \return - size_t - how many of the keys are there
+        size_t GetBatch(const std::string& section, const std::string* keys, size_t count, const std::string** values, bool* found = NULL);
+
     private:
+        //! \brief Handle one line, false if it is neither blank, a comment, a section nor key=value
+        bool ParseLine(const char* begin, const char* end, const std::string& key_value_seperator, std::string* section);
+
+        void Store(const std::string& section, const char* key, const char* key_end, const char* value, const char* value_end);
+
+        //! \brief kInterned: the slot probing for an entry starts at
+        size_t Home(uint32_t section_id, uint32_t key_id) const;
+
+        //! \brief kInterned: the slot of the entry, or the free slot it would go to
+        size_t Probe(uint32_t section_id, uint32_t key_id, size_t home) const;
+        void Grow();
+
+    private:
+        typedef std::unordered_map<std::string, std::string> KeyValueMap;
+        typedef std::unordered_map<std::string, KeyValueMap> SectionMap;
+
+        //! section == StringPool::kNoId marks a free slot
+        struct Slot
+        {
+            uint32_t section;
+            uint32_t key;
+            uint32_t value;
+        };
+
+        Storage             storage_;
+        SectionMap          sections_;      //! kStrings
+        StringPool          pool_;          //! kInterned
+        std::vector<Slot>   slots_;         //! kInterned, a power of two long
+        size_t              used_slots_;
+
+        INIParser(const INIParser&);
+        INIParser& operator=(const INIParser&);
     };
 }
 
@@ -1,7 +1,12 @@
 #include "ini_parser.h"
+#include "string_pool.h"
+#include "qh_metrics.h"
+#include "qh_workload.h"
 
+#include <stdio.h>
 #include <string.h>
 #include <assert.h>
+#include <map>
 
 void test1()
 {
@@ -14,7 +19,7 @@ void test1()
     const std::string& a = parser.Get("a", NULL);
     assert(a == "1");
 
-    std::string b = parser.Get("a", NULL);
+    std::string b = parser.Get("b", NULL);
     assert(b == "2");
 
     const std::string& c = parser.Get("c", NULL);
@@ -32,7 +37,7 @@ void test2()
     const std::string& a = parser.Get("a", NULL);
     assert(a == "1");
 
-    std::string b = parser.Get("a", NULL);
+    std::string b = parser.Get("b", NULL);
     assert(b == "2");
 
     const std::string& c = parser.Get("c", NULL);
@@ -50,13 +55,283 @@ void test3()
     const std::string& a = parser.Get("a", NULL);
     assert(a == "1");
 
-    std::string b = parser.Get("a", NULL);
+    std::string b = parser.Get("b", NULL);
     assert(b == "2");
 
     const std::string& c = parser.Get("c", NULL);
     assert(c == "3");
 }
 
+void test_sections(qh::INIParser::Storage storage)
+{
+    const char* ini_text =
+        "; a comment\n"
+        "name = top \r\n"
+        "\n"
+        "[ server ]\n"
+        "# another comment\n"
+        "host=127.0.0.1\n"
+        "port = 8360\n"
+        "url=http://a.com/?x=1\n"
+        "[client]\n"
+        "port=9000\n"
+        "empty=\n";
+    qh::INIParser parser(storage);
+    assert(parser.Parse(ini_text, strlen(ini_text), "\n", "="));
+
+    bool found = false;
+    assert(parser.Get("name", &found) == "top" && found);
+    assert(parser.Get("server", "host", &found) == "127.0.0.1" && found);
+    assert(parser.Get("server", "port", NULL) == "8360");
+    assert(parser.Get("server", "url", NULL) == "http://a.com/?x=1");
+    assert(parser.Get("client", "port", NULL) == "9000");
+    assert(parser.Get("client", "empty", &found) == "" && found);
+    assert(parser.Get("host", &found) == "" && !found);
+    assert(parser.Get("nosuch", "host", &found) == "" && !found);
+    assert(parser.Get("", "name", NULL) == "top");
+}
+
+void test_overwrite_and_merge(qh::INIParser::Storage storage)
+{
+    qh::INIParser parser(storage);
+    const char* first = "a=1\nb=2";
+    const char* second = "b=3";
+    assert(parser.Parse(first, strlen(first)));
+    assert(parser.Parse(second, strlen(second)));
+    assert(parser.Get("a", NULL) == "1");
+    assert(parser.Get("b", NULL) == "3");
+
+    // only the first separator splits
+    const char* text = "k::v::w";
+    assert(parser.Parse(text, strlen(text), "\n", "::"));
+    assert(parser.Get("k", NULL) == "v::w");
+
+    assert(parser.Parse("", 0));
+    assert(parser.Parse(NULL, 0));
+}
+
+void test_malformed(qh::INIParser::Storage storage)
+{
+    const char* bad[] = {"novalue", "=1", "[section", "a=1\njunk\n"};
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); ++i)
+    {
+        qh::INIParser parser(storage);
+        assert(!parser.Parse(bad[i], strlen(bad[i])));
+    }
+
+    qh::INIParser parser(storage);
+    assert(!parser.Parse("a=1", 3, "", "="));
+    assert(!parser.Parse("a=1", 3, "\n", ""));
+}
+
+void test_file()
+{
+    const char* path = "unittest_iniparser.ini";
+    FILE* f = fopen(path, "wb");
+    assert(f);
+    fputs("a=1\r\n[s]\r\nb = 2\r\n", f);
+    fclose(f);
+
+    qh::INIParser parser;
+    assert(parser.Parse(std::string(path)));
+    assert(parser.Get("a", NULL) == "1");
+    assert(parser.Get("s", "b", NULL) == "2");
+    remove(path);
+
+    assert(!parser.Parse(std::string("/nonexistent/file.ini")));
+}
+
+void test_workload(qh::INIParser::Storage storage)
+{
+    const char* separators[][2] = {{"\n", "="}, {"\r\n", "::"}, {"||", "=>"}};
+    for (size_t i = 0; i < sizeof(separators) / sizeof(separators[0]); ++i)
+    {
+        qh::workload::IniOptions options;
+        options.sections = 50;
+        options.keys_per_section = 40;
+        options.global_keys = 10;
+        options.max_depth = 4;
+        options.line_separator = separators[i][0];
+        options.key_value_separator = separators[i][1];
+        std::vector<qh::workload::IniEntry> entries;
+        std::string text = qh::workload::GenerateIni(options, 20140106 + i, &entries);
+
+        qh::INIParser parser(storage);
+        assert(parser.Parse(text.data(), text.size(), options.line_separator, options.key_value_separator));
+        for (size_t e = 0; e < entries.size(); ++e)
+        {
+            bool found = false;
+            assert(parser.Get(entries[e].section, entries[e].key, &found) == entries[e].value && found);
+        }
+    }
+}
+
+void test_string_pool()
+{
+    qh::StringPool pool;
+    assert(pool.size() == 0);
+    assert(pool.Find("a", 1) == qh::StringPool::kNoId);
+
+    uint32_t a = pool.Intern("a", 1);
+    const std::string& ref = pool.Get(a);
+    assert(pool.Intern("a", 1) == a);
+    assert(pool.Find("a", 1) == a);
+    uint32_t copy = pool.Add("a", 1);
+    assert(copy != a && pool.Get(copy) == "a");
+    assert(pool.Find("a", 1) == a);
+
+    // embedded NULs and the empty string are strings like any other
+    uint32_t nul = pool.Intern("a\0b", 3);
+    uint32_t empty = pool.Intern("", 0);
+    assert(nul != a && empty != a && empty != nul);
+    assert(pool.Get(nul) == std::string("a\0b", 3));
+    assert(pool.Get(empty).empty());
+
+    for (int i = 0; i < 10000; ++i)
+    {
+        char buf[16];
+        int len = snprintf(buf, sizeof(buf), "s%d", i);
+        pool.Intern(buf, len);
+    }
+    assert(pool.size() == 10004);
+    assert(&pool.Get(a) == &ref && ref == "a");
+    assert(pool.Find("s9999", 5) != qh::StringPool::kNoId);
+}
+
+void test_interned()
+{
+    qh::workload::IniOptions options;
+    options.sections = 300;
+    options.keys_per_section = 30;
+    options.global_keys = 5;
+    options.key_vocabulary = 20;
+    options.value_vocabulary = 50;
+    options.max_value_len = 2 * qh::INIParser::kMaxInternedValue;
+    std::vector<qh::workload::IniEntry> entries;
+    std::string text = qh::workload::GenerateIni(options, 7, &entries);
+
+    qh::INIParser strings(qh::INIParser::kStrings);
+    qh::INIParser interned(qh::INIParser::kInterned);
+    assert(strings.Parse(text.data(), text.size()));
+    assert(interned.Parse(text.data(), text.size()));
+
+    // a short value shared by two entries is one string
+    std::vector<const std::string*> refs;
+    std::map<std::string, const std::string*> first;
+    size_t shared = 0;
+    for (size_t e = 0; e < entries.size(); ++e)
+    {
+        const qh::workload::IniEntry& entry = entries[e];
+        const std::string& v = interned.Get(entry.section, entry.key, NULL);
+        assert(v == entry.value && v == strings.Get(entry.section, entry.key, NULL));
+        refs.push_back(&v);
+        if (v.size() <= qh::INIParser::kMaxInternedValue)
+        {
+            const std::string*& seen = first[v];
+            assert(!seen || seen == &v);
+            shared += seen != NULL;
+            seen = &v;
+        }
+    }
+    assert(shared > entries.size() / 2);
+
+    // references survive later parses that grow the pool and the table
+    qh::workload::IniOptions more = options;
+    more.key_vocabulary = 0;
+    more.value_vocabulary = 0;
+    std::string text2 = qh::workload::GenerateIni(more, 8);
+    assert(interned.Parse(text2.data(), text2.size()));
+    for (size_t e = 0; e < entries.size(); ++e)
+    {
+        assert(&interned.Get(entries[e].section, entries[e].key, NULL) == refs[e]);
+        assert(*refs[e] == entries[e].value);
+    }
+
+    // a replaced value does not disturb references to the old one
+    qh::INIParser parser(qh::INIParser::kInterned);
+    assert(parser.Parse("a=1\nb=1", 7));
+    const std::string& old_a = parser.Get("a", NULL);
+    assert(parser.Parse("a=2", 3));
+    assert(old_a == "1" && parser.Get("a", NULL) == "2" && parser.Get("b", NULL) == "1");
+}
+
+void test_get_batch(qh::INIParser::Storage storage)
+{
+    qh::workload::IniOptions options;
+    options.sections = 40;
+    options.keys_per_section = 50;
+    options.global_keys = 10;
+    options.key_vocabulary = 30;
+    std::vector<qh::workload::IniEntry> entries;
+    std::string text = qh::workload::GenerateIni(options, 9, &entries);
+    qh::INIParser parser(storage);
+    assert(parser.Parse(text.data(), text.size()));
+
+    // each section's keys in file order with a miss after every fourth,
+    // so that batches are full, partial and mixed
+    for (size_t begin = 0; begin < entries.size(); )
+    {
+        const std::string& section = entries[begin].section;
+        std::vector<std::string> keys;
+        for (; begin < entries.size() && entries[begin].section == section; ++begin)
+        {
+            keys.push_back(entries[begin].key);
+            if (keys.size() % 5 == 4)
+            {
+                keys.push_back("no_such_key");
+            }
+        }
+        keys.push_back(entries[0].key);     // a key of another section, or the global one again
+
+        std::vector<const std::string*> values(keys.size());
+        bool found[128];
+        size_t hits = parser.GetBatch(section, &keys[0], keys.size(), &values[0], found);
+        size_t expected_hits = 0;
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            bool one_found = false;
+            const std::string& one = parser.Get(section, keys[i], &one_found);
+            assert(values[i] == &one && found[i] == one_found);
+            expected_hits += one_found;
+        }
+        assert(hits == expected_hits && hits + keys.size() / 5 + 1 >= keys.size());
+        assert(parser.GetBatch(section, &keys[0], keys.size(), &values[0]) == hits);
+    }
+
+    std::string keys[] = {"a", "b"};
+    const std::string* values[2] = {NULL, NULL};
+    bool found[2] = {true, true};
+    assert(parser.GetBatch("no_such_section", keys, 2, values, found) == 0);
+    assert(values[0]->empty() && values[1]->empty() && !found[0] && !found[1]);
+    assert(parser.GetBatch("", keys, 0, values, found) == 0);
+
+    qh::INIParser empty(storage);
+    assert(empty.GetBatch("", keys, 2, values, found) == 0 && values[0]->empty() && !found[1]);
+}
+
+void test_metrics()
+{
+    const char* ini_text = "a=1\nb=2\n";
+    qh::metrics::Snapshot before = qh::metrics::TakeSnapshot();
+    qh::INIParser parser;
+    assert(parser.Parse(ini_text, strlen(ini_text), "\n", "="));
+    assert(parser.Get("a", NULL) == "1");
+    assert(parser.Get("b", NULL) == "2");
+    assert(parser.Get("c", NULL) == "");
+    qh::metrics::Snapshot after = qh::metrics::TakeSnapshot();
+
+    if (!qh::metrics::Enabled())
+    {
+        assert(after.counters.empty() && after.histograms.empty());
+        return;
+    }
+    assert(after.Counter("ini_parser.get.hits") - before.Counter("ini_parser.get.hits") == 2);
+    assert(after.Counter("ini_parser.get.misses") - before.Counter("ini_parser.get.misses") == 1);
+    assert(after.Counter("ini_parser.parse.bytes_scanned") - before.Counter("ini_parser.parse.bytes_scanned") == strlen(ini_text));
+    const qh::metrics::HistogramSnapshot* latency = after.Histogram("ini_parser.get.ns");
+    assert(latency && latency->count >= 3);
+}
+
 int main(int argc, char* argv[])
 {
     //TODO ӵԪԣԽԽã·ԽȫԽ
@@ -64,6 +339,20 @@ int main(int argc, char* argv[])
     test1();
     test2();
     test3();
+    test_sections(qh::INIParser::kStrings);
+    test_sections(qh::INIParser::kInterned);
+    test_overwrite_and_merge(qh::INIParser::kStrings);
+    test_overwrite_and_merge(qh::INIParser::kInterned);
+    test_malformed(qh::INIParser::kStrings);
+    test_malformed(qh::INIParser::kInterned);
+    test_file();
+    test_workload(qh::INIParser::kStrings);
+    test_workload(qh::INIParser::kInterned);
+    test_string_pool();
+    test_interned();
+    test_get_batch(qh::INIParser::kStrings);
+    test_get_batch(qh::INIParser::kInterned);
+    test_metrics();
 
     return 0;
 }
@@ -0,0 +1,84 @@
+#include "string_pool.h"
+
+#include <assert.h>
+#include <string.h>
+
+namespace qh
+{
+    StringPool::StringPool()
+        : interned_(0)
+    {
+    }
+
+    uint32_t StringPool::Intern( const char* s, size_t len )
+    {
+        if ((interned_ + 1) * 10 > index_.size() * 7)
+        {
+            Grow();
+        }
+        uint64_t hash = Hash(s, len);
+        uint32_t tag = static_cast<uint32_t>(hash >> 32);
+        size_t mask = index_.size() - 1;
+        size_t i = hash & mask;
+        for (; index_[i].id != kNoId; i = (i + 1) & mask)
+        {
+            const std::string& stored = strings_[index_[i].id];
+            if (index_[i].tag == tag && stored.size() == len && memcmp(stored.data(), s, len) == 0)
+            {
+                return index_[i].id;
+            }
+        }
+        index_[i].id = Add(s, len);
+        index_[i].tag = tag;
+        ++interned_;
+        return index_[i].id;
+    }
+
+    uint32_t StringPool::Add( const char* s, size_t len )
+    {
+        assert(strings_.size() < kNoId);
+        strings_.emplace_back(s, len);
+        return static_cast<uint32_t>(strings_.size() - 1);
+    }
+
+    uint32_t StringPool::Find( const char* s, size_t len, uint64_t hash ) const
+    {
+        if (index_.empty())
+        {
+            return kNoId;
+        }
+        uint32_t tag = static_cast<uint32_t>(hash >> 32);
+        size_t mask = index_.size() - 1;
+        for (size_t i = hash & mask; index_[i].id != kNoId; i = (i + 1) & mask)
+        {
+            const std::string& stored = strings_[index_[i].id];
+            if (index_[i].tag == tag && stored.size() == len && memcmp(stored.data(), s, len) == 0)
+            {
+                return index_[i].id;
+            }
+        }
+        return kNoId;
+    }
+
+    void StringPool::Grow()
+    {
+        Slot free_slot = {kNoId, 0};
+        std::vector<Slot> old(index_.empty() ? 16 : index_.size() * 2, free_slot);
+        old.swap(index_);
+        size_t mask = index_.size() - 1;
+        for (size_t i = 0; i < old.size(); ++i)
+        {
+            if (old[i].id == kNoId)
+            {
+                continue;
+            }
+            const std::string& stored = strings_[old[i].id];
+            size_t j = Hash(stored.data(), stored.size()) & mask;
+            while (index_[j].id != kNoId)
+            {
+                j = (j + 1) & mask;
+            }
+            index_[j] = old[i];
+        }
+    }
+}
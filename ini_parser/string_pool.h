@@ -0,0 +1,88 @@
+#ifndef QIHOO_STRING_POOL_H_
+#define QIHOO_STRING_POOL_H_
+
+#include <stdint.h>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <functional>
+#include <vector>
+
+namespace qh
+{
+    /**
+    * Strings named by dense 32 bit ids. Intern() stores equal strings once,
+    * Add() always appends, for strings not worth an index entry. References
+    * returned by Get() stay valid as long as the pool does.
+    *
+    * The index is one open addressing array, so a caller looking up many
+    * strings can Hash() them all and Prefetch() their slots before the
+    * first Find().
+    */
+    class StringPool
+    {
+    public:
+        static const uint32_t kNoId = 0xffffffffu;
+
+        StringPool();
+
+        //! \brief The id of an equal interned string, a new one if there is none
+        uint32_t Intern(const char* s, size_t len);
+
+        //! \brief A new id, even if an equal string is there already
+        uint32_t Add(const char* s, size_t len);
+
+        //! \return - uint32_t - the id of an equal interned string, kNoId if there is none
+        uint32_t Find(const char* s, size_t len) const
+        {
+            return Find(s, len, Hash(s, len));
+        }
+
+        //! \param[in] - uint64_t hash - Hash(s, len)
+        uint32_t Find(const char* s, size_t len, uint64_t hash) const;
+
+        static uint64_t Hash(const char* s, size_t len)
+        {
+            return std::hash<std::string_view>()(std::string_view(s, len));
+        }
+
+        //! \brief Start loading the index slot Find(..., hash) begins at
+        void Prefetch(uint64_t hash) const
+        {
+            if (!index_.empty())
+            {
+                __builtin_prefetch(&index_[hash & (index_.size() - 1)]);
+            }
+        }
+
+        const std::string& Get(uint32_t id) const
+        {
+            return strings_[id];
+        }
+
+        size_t size() const
+        {
+            return strings_.size();
+        }
+
+    private:
+        //! id == kNoId marks a free slot, tag is the high half of the hash
+        struct Slot
+        {
+            uint32_t id;
+            uint32_t tag;
+        };
+
+        void Grow();
+
+    private:
+        std::deque<std::string> strings_;       //! a deque never moves its elements
+        std::vector<Slot>       index_;         //! a power of two long, linear probing
+        size_t                  interned_;
+
+        StringPool(const StringPool&);
+        StringPool& operator=(const StringPool&);
+    };
+}
+
+#endif //QIHOO_STRING_POOL_H_
@@ -0,0 +1,143 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "qh_bench.h"
+#include "qh_metrics.h"
+#include "qh_workload.h"
+#include "proxy_url/tokener.h"
+#include "proxy_url/proxy_url_extractor.h"
+
+namespace
+{
+    const size_t kCalls = 1000000;
+
+    const char* kUrls[] = {
+        "http://www.microsofttranslator.com/bv.aspx?from=&to=zh-chs&a=http://hnujug.com/&xxx=kvpair_token",
+        "http://translate.baiducontent.com/transpage?cb=translateCallback&ie=utf8&source=url&query=cdmaw.com&from=en&to=zh&token=&monLang=zh",
+        "http://h02.hxsame.hexun.com/c?z=hexun&la=0&si=1&cg=64&c=819&ci=88&or=843&l=3456&bg=3456&b=3443&%23&u=http://23.80.77.56/22/e/4",
+        "http://www.microsofttranslator.com/bv.aspx?from=&to=zh-chs&uu=http://hnujug.com/&xxx=kvpair_token",
+    };
+    const size_t kUrlCount = sizeof(kUrls) / sizeof(kUrls[0]);
+
+    // Walk every key=value pair of the query the way code did before spans existed
+    size_t TokenizeWithStrings(const std::string& url)
+    {
+        qh::Tokener token(url);
+        token.skipTo('?');
+        token.next();
+        size_t bytes = 0;
+        while (!token.isEnd())
+        {
+            std::string key = token.nextString('=');
+            if (key.empty())
+            {
+                break;
+            }
+            // an empty result is either an empty value or no '&' left
+            const char* before = token.getCurReadPos();
+            std::string value = token.nextString('&');
+            if (token.getCurReadPos() == before)
+            {
+                value.assign(before, token.getReadableSize());
+                bytes += key.size() + value.size();
+                break;
+            }
+            bytes += key.size() + value.size();
+        }
+        return bytes;
+    }
+
+    size_t TokenizeWithSpans(const std::string& url)
+    {
+        qh::Tokener token(url);
+        token.skipTo('?');
+        token.next();
+        size_t bytes = 0;
+        qh::Span key;
+        qh::Span value;
+        while (token.nextSpan('=', &key) && token.nextSpanUntil('&', &value))
+        {
+            bytes += key.len + value.len;
+        }
+        return bytes;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::string urls[kUrlCount];
+    for (size_t i = 0; i < kUrlCount; ++i)
+    {
+        urls[i] = kUrls[i];
+    }
+    qh::ProxyURLExtractor::KeyItems keys;
+    keys.insert("a");
+    keys.insert("u");
+    keys.insert("url");
+    keys.insert("query");
+
+    size_t sink = 0;
+    qh::bench::Run("tokenize query with nextString", kCalls, [&]() {
+        for (size_t i = 0; i < kCalls; ++i)
+        {
+            sink += TokenizeWithStrings(urls[i % kUrlCount]);
+        }
+    });
+    qh::bench::Run("tokenize query with nextSpan", kCalls, [&]() {
+        for (size_t i = 0; i < kCalls; ++i)
+        {
+            sink += TokenizeWithSpans(urls[i % kUrlCount]);
+        }
+    });
+
+    std::string sub_url;
+    sub_url.reserve(256);
+    qh::bench::Run("ProxyURLExtractor::Extract", kCalls, [&]() {
+        for (size_t i = 0; i < kCalls; ++i)
+        {
+            qh::ProxyURLExtractor::Extract(keys, urls[i % kUrlCount], sub_url);
+            sink += sub_url.size();
+        }
+    });
+
+    // generated corpora: how the hit rate and the query length move the cost
+    const double hit_rates[] = {0.0, 0.5, 1.0};
+    const size_t max_params[] = {8, 64};
+    for (size_t p = 0; p < sizeof(max_params) / sizeof(max_params[0]); ++p)
+    {
+        for (size_t h = 0; h < sizeof(hit_rates) / sizeof(hit_rates[0]); ++h)
+        {
+            qh::workload::UrlOptions options;
+            options.hit_rate = hit_rates[h];
+            options.max_params = max_params[p];
+            std::vector<qh::workload::UrlSample> corpus = qh::workload::GenerateUrls(options, 10000, qh::bench::Seed());
+            size_t bytes = 0;
+            for (size_t i = 0; i < corpus.size(); ++i)
+            {
+                bytes += corpus[i].url.size();
+            }
+
+            char name[96];
+            snprintf(name, sizeof(name), "ProxyURLExtractor::Extract/corpus hit_rate=%.1f params=1..%zu", hit_rates[h], max_params[p]);
+            const size_t kRounds = 20;
+            double ns = qh::bench::Run(name, kRounds * corpus.size(), [&]() {
+                for (size_t r = 0; r < kRounds; ++r)
+                {
+                    for (size_t i = 0; i < corpus.size(); ++i)
+                    {
+                        qh::ProxyURLExtractor::Extract(keys, corpus[i].url, sub_url);
+                        sink += sub_url.size();
+                    }
+                }
+            });
+            qh::bench::Report(name, "MB/s", bytes / (ns * corpus.size()) * 1e3);
+        }
+    }
+    qh::bench::DoNotOptimize(sink);
+
+    // make bench METRICS=1: the recorded metrics go to stderr, stdout stays JSON
+    qh::metrics::TakeSnapshot().Dump(stderr);
+    return 0;
+}
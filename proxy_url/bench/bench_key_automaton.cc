@@ -0,0 +1,82 @@
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "qh_bench.h"
+#include "qh_workload.h"
+#include "proxy_url/key_automaton.h"
+#include "proxy_url/proxy_url_extractor.h"
+
+namespace
+{
+    std::vector<std::string> MakeKeys(size_t count)
+    {
+        std::vector<std::string> keys = qh::workload::DefaultKeys();
+        qh::bench::Random rng;
+        while (keys.size() < count)
+        {
+            std::string key;
+            size_t len = rng.Range(2, 10);
+            for (size_t i = 0; i < len; ++i)
+            {
+                key.push_back(static_cast<char>('a' + rng.Uniform(26)));
+            }
+            keys.push_back(key);
+        }
+        keys.resize(count);
+        return keys;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t key_counts[] = {4, 16, 64, 256, 1024};
+    const size_t max_params[] = {8, 64};
+    const size_t kRounds = 20;
+    size_t sink = 0;
+    std::string sub_url;
+    sub_url.reserve(4096);
+
+    for (size_t p = 0; p < sizeof(max_params) / sizeof(max_params[0]); ++p)
+    {
+        for (size_t k = 0; k < sizeof(key_counts) / sizeof(key_counts[0]); ++k)
+        {
+            qh::workload::UrlOptions options;
+            options.keys = MakeKeys(key_counts[k]);
+            options.max_params = max_params[p];
+            options.decoy_rate = 0.2;
+            std::vector<qh::workload::UrlSample> corpus = qh::workload::GenerateUrls(options, 10000, qh::bench::Seed());
+            qh::ProxyURLExtractor::KeyItems keys(options.keys.begin(), options.keys.end());
+            qh::KeyAutomaton automaton(keys);
+            size_t ops = kRounds * corpus.size();
+
+            char name[96];
+            snprintf(name, sizeof(name), "Extract per-parameter set lookup/keys=%zu params=1..%zu", key_counts[k], max_params[p]);
+            qh::bench::Run(name, ops, [&]() {
+                for (size_t r = 0; r < kRounds; ++r)
+                {
+                    for (size_t i = 0; i < corpus.size(); ++i)
+                    {
+                        qh::ProxyURLExtractor::Extract(keys, corpus[i].url, sub_url);
+                        sink += sub_url.size();
+                    }
+                }
+            });
+
+            snprintf(name, sizeof(name), "KeyAutomaton::Extract/keys=%zu params=1..%zu", key_counts[k], max_params[p]);
+            qh::bench::Run(name, ops, [&]() {
+                for (size_t r = 0; r < kRounds; ++r)
+                {
+                    for (size_t i = 0; i < corpus.size(); ++i)
+                    {
+                        automaton.Extract(corpus[i].url, sub_url);
+                        sink += sub_url.size();
+                    }
+                }
+            });
+            qh::bench::Report(name, "table_kb", automaton.state_count() * automaton.class_count() * sizeof(uint32_t) / 1024.0);
+        }
+    }
+    qh::bench::DoNotOptimize(sink);
+    return 0;
+}
@@ -0,0 +1,122 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+#include "qh_bench.h"
+#include "qh_workload.h"
+#include "proxy_url/key_automaton.h"
+#include "proxy_url/proxy_url_extractor.h"
+#include "proxy_url/static_key_set.h"
+
+int main(int argc, char* argv[])
+{
+    // the built in keys of DefaultStaticKeySet, the same as DefaultKeys()
+    std::vector<std::string> words = qh::workload::DefaultKeys();
+    qh::ProxyURLExtractor::KeyItems keys(words.begin(), words.end());
+    qh::KeyAutomaton automaton(keys);
+
+    // the same keys behind ProxyURLExtractor, from a rule file and built in
+    qh::ProxyURLExtractor from_file;
+    char path[] = "/tmp/bench_static_key_set_XXXXXX";
+    int fd = mkstemp(path);
+    for (size_t i = 0; fd >= 0 && i < words.size(); ++i)
+    {
+        std::string line = words[i] + "\n";
+        if (write(fd, line.data(), line.size()) != static_cast<ssize_t>(line.size()))
+        {
+            fd = -1;
+        }
+    }
+    if (fd < 0 || close(fd) != 0 || !from_file.Initialize(path))
+    {
+        fprintf(stderr, "can not write the rule file %s\n", path);
+        return 1;
+    }
+    unlink(path);
+    qh::ProxyURLExtractor built_in;
+    built_in.Initialize<qh::DefaultStaticKeySet>();
+
+    const size_t max_params[] = {8, 64};
+    const double hit_rates[] = {0.1, 0.9};
+    // a corpus that stays in cache, so the runs compare scans and not misses
+    const size_t kRounds = 200;
+    size_t sink = 0;
+    std::string sub_url;
+    sub_url.reserve(4096);
+
+    for (size_t p = 0; p < sizeof(max_params) / sizeof(max_params[0]); ++p)
+    {
+        for (size_t h = 0; h < sizeof(hit_rates) / sizeof(hit_rates[0]); ++h)
+        {
+            qh::workload::UrlOptions options;
+            options.max_params = max_params[p];
+            options.hit_rate = hit_rates[h];
+            options.decoy_rate = 0.2;
+            std::vector<qh::workload::UrlSample> corpus = qh::workload::GenerateUrls(options, 1000, qh::bench::Seed());
+            size_t ops = kRounds * corpus.size();
+            char name[96];
+
+            snprintf(name, sizeof(name), "Extract KeyItems/hit=%.1f params=1..%zu", hit_rates[h], max_params[p]);
+            qh::bench::Run(name, ops, [&]() {
+                for (size_t r = 0; r < kRounds; ++r)
+                {
+                    for (size_t i = 0; i < corpus.size(); ++i)
+                    {
+                        qh::ProxyURLExtractor::Extract(keys, corpus[i].url, sub_url);
+                        sink += sub_url.size();
+                    }
+                }
+            });
+
+            snprintf(name, sizeof(name), "KeyAutomaton::Extract/hit=%.1f params=1..%zu", hit_rates[h], max_params[p]);
+            qh::bench::Run(name, ops, [&]() {
+                for (size_t r = 0; r < kRounds; ++r)
+                {
+                    for (size_t i = 0; i < corpus.size(); ++i)
+                    {
+                        automaton.Extract(corpus[i].url, sub_url);
+                        sink += sub_url.size();
+                    }
+                }
+            });
+
+            snprintf(name, sizeof(name), "DefaultStaticKeySet::Extract/hit=%.1f params=1..%zu", hit_rates[h], max_params[p]);
+            qh::bench::Run(name, ops, [&]() {
+                for (size_t r = 0; r < kRounds; ++r)
+                {
+                    for (size_t i = 0; i < corpus.size(); ++i)
+                    {
+                        qh::DefaultStaticKeySet::Extract(corpus[i].url, sub_url);
+                        sink += sub_url.size();
+                    }
+                }
+            });
+
+            snprintf(name, sizeof(name), "ProxyURLExtractor rule file/hit=%.1f params=1..%zu", hit_rates[h], max_params[p]);
+            qh::bench::Run(name, ops, [&]() {
+                for (size_t r = 0; r < kRounds; ++r)
+                {
+                    for (size_t i = 0; i < corpus.size(); ++i)
+                    {
+                        sink += from_file.Extract(corpus[i].url).size();
+                    }
+                }
+            });
+
+            snprintf(name, sizeof(name), "ProxyURLExtractor Initialize<DefaultStaticKeySet>/hit=%.1f params=1..%zu", hit_rates[h], max_params[p]);
+            qh::bench::Run(name, ops, [&]() {
+                for (size_t r = 0; r < kRounds; ++r)
+                {
+                    for (size_t i = 0; i < corpus.size(); ++i)
+                    {
+                        sink += built_in.Extract(corpus[i].url).size();
+                    }
+                }
+            });
+        }
+    }
+    qh::bench::DoNotOptimize(sink);
+    return 0;
+}
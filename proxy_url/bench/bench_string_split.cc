@@ -0,0 +1,66 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <fstream>
+
+#include "qh_bench.h"
+#include "qh_small_vector.h"
+#include "proxy_url/string_split.h"
+#include "proxy_url/proxy_url_extractor.h"
+
+namespace
+{
+    const size_t kCalls = 1000000;
+
+    // A rule line and a query string, split the way the extractor does it
+    const std::string kLines[] = {
+        "a,u,url,curl,query,uri",
+        "from=&to=zh-chs&a=http://hnujug.com/",
+    };
+
+    template<class Vector>
+    void Split(const char* name, const std::string& line, const char* delims)
+    {
+        size_t pieces = 0;
+        qh::bench::Run(name, kCalls, [&]() {
+            for (size_t i = 0; i < kCalls; ++i)
+            {
+                Vector v;
+                qh::StringSplit(line, delims, 0, v);
+                pieces += v.size();
+                qh::bench::DoNotOptimize(v[0]);
+            }
+        });
+        qh::bench::Report(name, "pieces/call", static_cast<double>(pieces) / kCalls);
+    }
+
+    void Initialize()
+    {
+        const char* path = "bench_string_split.rules";
+        const size_t kRuleLines = 10000;
+        {
+            std::ofstream ofs(path);
+            for (size_t i = 0; i < kRuleLines; ++i)
+            {
+                ofs << "a,u,url,curl,query,uri" << "\n";
+            }
+        }
+
+        qh::bench::Run("Initialize/rule line", kRuleLines, [path]() {
+            qh::ProxyURLExtractor extractor;
+            extractor.Initialize(path);
+        });
+        remove(path);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Split<std::vector<std::string> >("StringSplit/keys/std::vector", kLines[0], ",");
+    Split<qh::small_vector<std::string, 8> >("StringSplit/keys/qh::small_vector<8>", kLines[0], ",");
+    Split<std::vector<std::string> >("StringSplit/query/std::vector", kLines[1], "&");
+    Split<qh::small_vector<std::string, 8> >("StringSplit/query/qh::small_vector<8>", kLines[1], "&");
+    Initialize();
+    return 0;
+}
@@ -0,0 +1,156 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+#include "qh_bench.h"
+#include "proxy_url/tokener.h"
+
+namespace legacy
+{
+    // The Tokener core before it went 64 bit: every step checks for a NUL
+    // and skipTo()/nextString(quote) walk one next() at a time
+    class Tokener
+    {
+    public:
+        Tokener(const char* ps, int len) : m_pData(ps), m_pCurPos(ps), m_pDataEnd(ps + len) {}
+
+        bool isEnd() const
+        {
+            return ( m_pCurPos >= m_pDataEnd || *m_pCurPos == '\0' );
+        }
+
+        char next()
+        {
+            if ( isEnd() )
+            {
+                ++m_pCurPos;
+                return 0;
+            }
+            return *m_pCurPos++;
+        }
+
+        bool back()
+        {
+            if ( m_pCurPos <= m_pData )
+            {
+                return false;
+            }
+            --m_pCurPos;
+            return true;
+        }
+
+        std::string nextString( char quote )
+        {
+            const char* startpos = m_pCurPos;
+            while ( *m_pCurPos++ != quote )
+            {
+                if ( isEnd() )
+                {
+                    m_pCurPos = startpos;
+                    return std::string();
+                }
+            }
+            return std::string( startpos, m_pCurPos - startpos - 1 );
+        }
+
+        char skipTo( char to )
+        {
+            char c = 0;
+            const char* startIndex = this->m_pCurPos;
+            do
+            {
+                c = next();
+                if ( c == 0 )
+                {
+                    m_pCurPos = startIndex;
+                    return c;
+                }
+            }
+            while ( c != to );
+            back();
+            return c;
+        }
+
+    private:
+        const char* m_pData;
+        const char* m_pCurPos;
+        const char* m_pDataEnd;
+    };
+}
+
+namespace
+{
+    // key=value pairs with values of a typical proxied URL's length
+    std::string MakeQuery(size_t bytes)
+    {
+        std::string query;
+        unsigned int seed = 20140106;
+        while (query.size() < bytes)
+        {
+            seed = seed * 1103515245 + 12345;
+            char pair[256];
+            int value_len = 8 + (seed >> 16) % 120;
+            int n = snprintf(pair, sizeof(pair), "key%u=", (seed >> 8) % 1000);
+            query.append(pair, n);
+            query.append(value_len, 'v');
+            query.push_back('&');
+        }
+        return query;
+    }
+
+    template<class T>
+    size_t ScanPairs(T& token)
+    {
+        size_t pairs = 0;
+        while (!token.isEnd())
+        {
+            std::string key = token.nextString('=');
+            pairs += key.size() != 0;
+            if (token.skipTo('&') == 0)
+            {
+                break;
+            }
+            token.next();
+        }
+        return pairs;
+    }
+
+    template<class T>
+    size_t WalkBytes(T& token)
+    {
+        size_t sum = 0;
+        while (!token.isEnd())
+        {
+            sum += static_cast<unsigned char>(token.next());
+        }
+        return sum;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t bytes = 64 << 20;
+    std::string query = MakeQuery(bytes);
+    const int len = static_cast<int>(query.size());
+    size_t result = 0;
+
+    qh::bench::Run("legacy Tokener next() per byte", len, [&]() {
+        legacy::Tokener token(query.data(), len);
+        result += WalkBytes(token);
+    });
+    qh::bench::Run("Tokener next() per byte", len, [&]() {
+        qh::Tokener token(query.data(), len);
+        result += WalkBytes(token);
+    });
+
+    qh::bench::Run("legacy Tokener nextString+skipTo per byte", len, [&]() {
+        legacy::Tokener token(query.data(), len);
+        result += ScanPairs(token);
+    });
+    qh::bench::Run("Tokener nextString+skipTo per byte", len, [&]() {
+        qh::Tokener token(query.data(), len);
+        result += ScanPairs(token);
+    });
+    qh::bench::DoNotOptimize(result);
+    return 0;
+}
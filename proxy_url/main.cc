@@ -1,8 +1,17 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
+#include "proxy_url/key_automaton.h"
 #include "proxy_url/proxy_url_extractor.h"
+#include "proxy_url/static_key_set.h"
+#include "proxy_url/string_split.h"
+#include "proxy_url/tokener.h"
+#include "qh_metrics.h"
+#include "qh_small_vector.h"
+#include "qh_workload.h"
 
 #define H_ARRAYSIZE(a) \
     ((sizeof(a) / sizeof(*(a))) / \
@@ -38,8 +47,10 @@ void test_ProxUrlExtractor_Extract1()
     };
 
     bool all_test_ok = true;
+    KeyAutomaton automaton(keys);
     for (size_t i = 0; i < H_ARRAY_SIZE(test_data); i++)
     {
+        assert(automaton.Extract(test_data[i][0]) == test_data[i][1]);
         if (ProxyURLExtractor::Extract(keys, test_data[i][0]) != test_data[i][1]) {
             //fprintf(stderr, "test failed [%s]\n", test_data[i][0].data());
             all_test_ok = false;
@@ -126,8 +137,10 @@ void test_ProxUrlExtractor_Extract2()
 
 
     bool all_test_ok = true;
+    KeyAutomaton automaton(keys);
     for (size_t i = 0; i < H_ARRAY_SIZE(test_data); i++)
     {
+        assert(automaton.Extract(test_data[i][0]) == test_data[i][1]);
         if (ProxyURLExtractor::Extract(keys, test_data[i][0]) != test_data[i][1]) {
             fprintf(stderr, "test failed [%s]\n", test_data[i][0].data());
             all_test_ok = false;
@@ -149,10 +162,372 @@ void test_ProxUrlExtractor_Extract2()
     }
 }
 
+void test_StringSplit()
+{
+    qh::small_vector<std::string, 4> pieces;
+    qh::StringSplit(std::string("a,u,,url"), ",", 0, pieces);
+    assert(pieces.size() == 4);
+    assert(pieces.is_small());
+    assert(pieces[0] == "a" && pieces[1] == "u" && pieces[2] == "" && pieces[3] == "url");
+
+    pieces.clear();
+    qh::StringSplit(std::string("a,u,url,curl,query"), ",", 0, pieces);
+    assert(pieces.size() == 5);
+    assert(!pieces.is_small());
+    assert(pieces[4] == "query");
+
+    pieces.clear();
+    qh::StringSplit(std::string("a,u,url"), ",", 2, pieces);
+    assert(pieces.size() == 2);
+    assert(pieces[1] == "u,url");
+}
+
+void test_Tokener()
+{
+    qh::Tokener token("k1=v1&k2=v2&k3");
+    assert(token.nextString('=') == "k1");
+    assert(token.skipTo('&'));
+    assert(token.getCurPos() == 5);
+    assert(token.next() == '&');
+    assert(token.nextString('=') == "k2");
+    assert(token.nextString('#') == "");
+    assert(token.getCurPos() == 9);
+    assert(!token.skipTo('#'));
+    assert(token.getCurPos() == 9);
+    assert(token.skipBackTo('='));
+    assert(token.getCurPos() == 9);
+    assert(token.skipBackTo('k'));
+    assert(token.getCurPos() == 7);
+    assert(!token.skipBackTo('#'));
+    assert(token.getCurPos() == 7);
+    assert(token.getReadableSize() == 7);
+
+    // with an explicit length a NUL byte is just another character
+    const char binary[] = "a\0b=c d";
+    token.reset(binary, sizeof(binary) - 1);
+    assert(token.size() == 7);
+    assert(token.next() == 'a');
+    assert(!token.isEnd());
+    assert(token.current() == '\0');
+    assert(token.skipTo('\0') && token.getCurPos() == 1);
+    assert(token.nextString('=') == std::string("\0b", 2));
+    assert(token.nextString() == "c");
+    assert(token.nextString() == "d");
+    assert(token.isEnd());
+    assert(token.next() == 0);
+    assert(token.skipBackTo(' '));
+    assert(token.nextString() == "d");
+    assert(token.skipBackTo('\0') && token.getCurPos() == 2);
+    assert(!token.skipTo('\0'));
+
+    // the length is not clipped to the first NUL, nor to the terminating one
+    token.reset("abc", 2);
+    assert(!token.skipTo('c'));
+    assert(token.nextString() == "ab");
+
+    // spans slice the source without copying
+    const char* query = "a=1&&bb=22 c";
+    token.reset(query);
+    qh::Span span;
+    assert(token.nextSpan('=', &span) && span.data == query && span.len == 1);
+    assert(token.nextSpanUntil('&', &span) && span.str() == "1");
+    assert(token.nextSpanUntil('&', &span) && span.empty());
+    assert(!token.nextSpan('#', &span));
+    assert(token.getCurPos() == 5);
+    assert(token.nextSpan(&span) && span.str() == "bb=22");
+    assert(token.nextSpanUntil('&', &span) && span.str() == "c");
+    assert(token.isEnd());
+    assert(!token.nextSpanUntil('&', &span));
+    assert(!token.nextSpan(&span));
+    assert(!token.nextSpan('=', &span));
+    assert(token.back(100) == false);
+
+    token.reset(NULL, -1);
+    assert(token.isEnd() && token.size() == 0);
+    token.reset(NULL, 5);
+    assert(token.isEnd() && token.size() == 0 && token.next() == 0);
+    token.reset("k=v", -1);
+    assert(token.size() == 3 && token.nextString('=') == "k");
+    assert(!token.skipTo('x') && !token.skipBackTo('x'));
+
+    // positions past 4GB, the pages are never touched except the last one
+    const qh::u64 huge = (4ULL << 30) + 4096;
+    void* region = mmap(NULL, huge, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (region != MAP_FAILED)
+    {
+        char* data = static_cast<char*>(region);
+        data[huge - 2] = '=';
+        token.reset(data, huge);
+        assert(token.getReadableSize() == static_cast<qh::s64>(huge));
+        assert(token.skipTo('='));
+        assert(token.getCurPos() == huge - 2);
+        assert(token.getReadableSize() == 2);
+        munmap(region, huge);
+    }
+}
+
+void test_Extract_workload()
+{
+    qh::ProxyURLExtractor::KeyItems keys;
+    std::vector<std::string> key_list = qh::workload::DefaultKeys();
+    keys.insert(key_list.begin(), key_list.end());
+
+    qh::workload::UrlOptions options;
+    options.min_params = 0;
+    options.max_params = 40;
+    options.min_value_len = 0;
+    options.decoy_rate = 0.3;
+    options.max_nesting = 3;
+    std::vector<qh::workload::UrlSample> samples = qh::workload::GenerateUrls(options, 20000, 20140106);
+    std::string sub_url;
+    for (size_t i = 0; i < samples.size(); ++i)
+    {
+        qh::ProxyURLExtractor::Extract(keys, samples[i].url, sub_url);
+        assert(sub_url == samples[i].expected);
+    }
+}
+
+void test_KeyAutomaton()
+{
+    qh::ProxyURLExtractor::KeyItems keys;
+    keys.insert("u");
+    keys.insert("uri");
+    keys.insert("url");
+    keys.insert("a=b");     // can never name a parameter
+    keys.insert("x&y");
+    qh::KeyAutomaton automaton(keys);
+    // dead, match, root and one state per distinct key prefix: u ur uri url
+    assert(automaton.state_count() == 3 + 4);
+
+    // every byte a key may hold gets its own class, none merges with another
+    qh::ProxyURLExtractor::KeyItems every_byte;
+    for (int c = 0; c < 256; ++c)
+    {
+        if (c != '&' && c != '=')
+        {
+            every_byte.insert(std::string(1, static_cast<char>(c)) + "k");
+        }
+    }
+    qh::KeyAutomaton wide(every_byte);
+    assert(wide.class_count() == 3 + 254);
+    for (int c = 0; c < 256; ++c)
+    {
+        std::string url = "http://a.com/?" + std::string(1, static_cast<char>(c)) + "k=v";
+        assert(wide.Extract(url) == (c == '&' || c == '=' ? "" : "v"));
+        assert(wide.Extract(url) == qh::ProxyURLExtractor::Extract(every_byte, url));
+    }
+
+    const char* cases[] = {
+        "http://a.com/",
+        "http://a.com/?",
+        "http://a.com/?url",
+        "http://a.com/?url=",
+        "http://a.com/?url=&",
+        "http://a.com/?url=&uri=x",
+        "http://a.com/?&&&u=1",
+        "http://a.com/?uu=1&ur=2&urll=3&url=4",
+        "http://a.com/?xurl=1&url%3D=2&url==3",
+        "http://a.com/?x=url=1&u=?&url=2",
+        "http://a.com/???&url=1",
+        "http://a.com/?a=b=1&x&y=2&uri=3",
+        "http://a.com/?u",
+        "http://a.com/?q=1#&url=frag",
+        "?url=1",
+    };
+    for (size_t i = 0; i < H_ARRAY_SIZE(cases); ++i)
+    {
+        assert(automaton.Extract(cases[i]) == qh::ProxyURLExtractor::Extract(keys, cases[i]));
+    }
+    assert(automaton.Extract("http://a.com/?url==3") == "=3");
+    assert(automaton.Extract("http://a.com/?x=url=1&u=?&url=2") == "?");
+
+    // NUL bytes are ordinary characters
+    std::string with_nul("http://a.com/?x=\0&url=a\0b", 25);
+    assert(automaton.Extract(with_nul) == std::string("a\0b", 3));
+
+    // an empty key names the parameters without a name
+    qh::ProxyURLExtractor::KeyItems empty_key;
+    empty_key.insert("");
+    assert(qh::KeyAutomaton(empty_key).Extract("http://a.com/?x=1&=2") == "2");
+    assert(qh::ProxyURLExtractor::Extract(empty_key, "http://a.com/?x=1&=2") == "2");
+    assert(qh::KeyAutomaton().Extract("http://a.com/?url=1") == "");
+
+    // Initialize compiles the rule file for Extract(url)
+    char path[] = "/tmp/proxy_url_keys_XXXXXX";
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    const char rules[] = "a,u\nurl,,query\n\ncurl\n";
+    assert(write(fd, rules, sizeof(rules) - 1) == static_cast<ssize_t>(sizeof(rules) - 1));
+    close(fd);
+    qh::ProxyURLExtractor extractor;
+    assert(extractor.Initialize(path));
+    unlink(path);
+    assert(extractor.Extract("http://a.com/?x=1&curl=2&url=3") == "2");
+    assert(extractor.Extract("http://a.com/?x=1&query=&a=4") == "4");
+    assert(extractor.Extract("http://a.com/?x=1&uri=5") == "");
+
+    // many keys sharing prefixes, on a decoy heavy corpus
+    qh::workload::UrlOptions options;
+    qh::Random rng(20140106);
+    for (size_t k = 0; k < 300; ++k)
+    {
+        std::string key;
+        size_t len = 1 + rng.Uniform(8);
+        for (size_t i = 0; i < len; ++i)
+        {
+            key.push_back("abcdu"[rng.Uniform(5)]);
+        }
+        options.keys.push_back(key);
+    }
+    options.decoy_rate = 0.4;
+    options.min_params = 0;
+    options.max_params = 30;
+    options.min_value_len = 0;
+    keys.clear();
+    keys.insert(options.keys.begin(), options.keys.end());
+    automaton.Build(keys);
+    std::vector<qh::workload::UrlSample> samples = qh::workload::GenerateUrls(options, 20000, 41);
+    for (size_t i = 0; i < samples.size(); ++i)
+    {
+        assert(automaton.Extract(samples[i].url) == samples[i].expected);
+    }
+}
+
+namespace
+{
+    constexpr char kUrlKey[] = "url";
+    constexpr char kUriKey[] = "uri";
+    constexpr char kLongKey[] = "a_rather_long_proxy_key";
+}
+
+void test_StaticKeySet()
+{
+    typedef qh::StaticKeySet<kUrlKey, kUriKey, kLongKey> Keys;
+    static_assert(Keys::size() == 3, "three keys");
+    qh::ProxyURLExtractor::KeyItems keys;
+    keys.insert("url");
+    keys.insert("uri");
+    keys.insert("a_rather_long_proxy_key");
+
+    assert(Keys::Contains("url", 3) && Keys::Contains("a_rather_long_proxy_key", 23));
+    assert(!Keys::Contains("ur", 2) && !Keys::Contains("urll", 4) && !Keys::Contains("", 0));
+    assert(!Keys::Contains("a_rather_long_proxy_kex", 23) && !Keys::Contains("a_rather_long_proxy_key_", 24));
+
+    const char* cases[] = {
+        "http://a.com/",
+        "http://a.com/?",
+        "http://a.com/?url",
+        "http://a.com/?url=",
+        "http://a.com/?url=&uri=x",
+        "http://a.com/?uu=1&ur=2&urll=3&url=4",
+        "http://a.com/?xurl=1&url%3D=2&url==3",
+        "http://a.com/?x=url=1&uri=?&url=2",
+        "http://a.com/???&url=1",
+        "http://a.com/?a_rather_long_proxy_ke=1&a_rather_long_proxy_key=2",
+        "http://a.com/?q=1#&url=frag",
+        "http://a.com/?a_rather_long_proxy_key_too=1&url=2",
+        "http://a.com/?a_rather_long_proxy_keys",
+        "http://a.com/?&&=url&url=&uri=",
+        "http://a.com/?url=1&",
+        "?url=1",
+    };
+    for (size_t i = 0; i < H_ARRAY_SIZE(cases); ++i)
+    {
+        assert(Keys::Extract(cases[i]) == qh::ProxyURLExtractor::Extract(keys, cases[i]));
+    }
+    std::string with_nul("http://a.com/?x=\0&url=a\0b", 25);
+    assert(Keys::Extract(with_nul) == std::string("a\0b", 3));
+    std::string sub_url = "stale";
+    Keys::Extract("http://a.com/?x=1", sub_url);
+    assert(sub_url.empty());
+
+    // the built in set agrees with the rule file path on a whole corpus
+    qh::ProxyURLExtractor::KeyItems default_keys;
+    std::vector<std::string> words = qh::workload::DefaultKeys();
+    default_keys.insert(words.begin(), words.end());
+    assert(qh::DefaultStaticKeySet::size() == default_keys.size());
+    qh::workload::UrlOptions options;
+    options.decoy_rate = 0.3;
+    options.max_nesting = 3;
+    std::vector<qh::workload::UrlSample> samples = qh::workload::GenerateUrls(options, 5000, 45);
+    for (size_t i = 0; i < samples.size(); ++i)
+    {
+        assert(qh::DefaultStaticKeySet::Extract(samples[i].url) == samples[i].expected);
+        assert(qh::DefaultStaticKeySet::Extract(samples[i].url) == qh::ProxyURLExtractor::Extract(default_keys, samples[i].url));
+    }
+
+    // behind ProxyURLExtractor, until a rule file adds keys to it
+    qh::ProxyURLExtractor extractor;
+    extractor.Initialize<qh::DefaultStaticKeySet>();
+    for (size_t i = 0; i < samples.size(); ++i)
+    {
+        assert(extractor.Extract(samples[i].url) == samples[i].expected);
+    }
+    char path[] = "/tmp/proxy_url_keys_XXXXXX";
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    assert(write(fd, "next\n", 5) == 5);
+    close(fd);
+    assert(extractor.Initialize(path));
+    unlink(path);
+    assert(extractor.Extract("http://a.com/?next=1&url=2") == "1");
+    assert(extractor.Extract("http://a.com/?x=1&url=2") == "2");
+}
+
+void test_Extract_metrics()
+{
+    qh::ProxyURLExtractor::KeyItems keys;
+    keys.insert("url");
+    std::string hit = "http://a.com/r?x=1&url=http://b.com/&y=2";
+    std::string miss = "http://a.com/r?x=1&y=2";
+    std::string no_query = "http://a.com/r";
+
+    qh::metrics::Snapshot before = qh::metrics::TakeSnapshot();
+    assert(qh::ProxyURLExtractor::Extract(keys, hit) == "http://b.com/");
+    assert(qh::ProxyURLExtractor::Extract(keys, miss) == "");
+    assert(qh::ProxyURLExtractor::Extract(keys, no_query) == "");
+    qh::metrics::Snapshot after = qh::metrics::TakeSnapshot();
+
+    if (!qh::metrics::Enabled())
+    {
+        assert(after.counters.empty() && after.histograms.empty());
+        return;
+    }
+    assert(after.Counter("proxy_url.extract.hits") - before.Counter("proxy_url.extract.hits") == 1);
+    assert(after.Counter("proxy_url.extract.misses") - before.Counter("proxy_url.extract.misses") == 2);
+    // the hit stops at the end of its value, "&y=2" is never looked at
+    uint64_t scanned = hit.size() - 4 + miss.size() + no_query.size();
+    assert(after.Counter("proxy_url.extract.bytes_scanned") - before.Counter("proxy_url.extract.bytes_scanned") == scanned);
+
+    // Extract(url) counts the same bytes as Extract(keys, url)
+    char path[] = "/tmp/proxy_url_keys_XXXXXX";
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    assert(write(fd, "url\n", 4) == 4);
+    close(fd);
+    qh::ProxyURLExtractor extractor;
+    assert(extractor.Initialize(path));
+    unlink(path);
+    before = qh::metrics::TakeSnapshot();
+    assert(extractor.Extract(hit) == "http://b.com/");
+    assert(extractor.Extract(miss) == "");
+    assert(extractor.Extract(no_query) == "");
+    after = qh::metrics::TakeSnapshot();
+    assert(after.Counter("proxy_url.extract.bytes_scanned") - before.Counter("proxy_url.extract.bytes_scanned") == scanned);
+    const qh::metrics::HistogramSnapshot* latency = after.Histogram("proxy_url.extract.ns");
+    assert(latency && latency->count >= 3);
+}
+
 int main(int argc, char* argv[])
 {
+    test_StringSplit();
+    test_Tokener();
     test_ProxUrlExtractor_Extract1();
     test_ProxUrlExtractor_Extract2();
+    test_Extract_workload();
+    test_KeyAutomaton();
+    test_StaticKeySet();
+    test_Extract_metrics();
 #ifdef WIN32
     system("pause");
 #endif
@@ -0,0 +1,155 @@
+#include "key_automaton.h"
+
+#include <string.h>
+#include <algorithm>
+
+namespace qh
+{
+    namespace
+    {
+        const uint16_t kOtherClass = 0;
+        const uint16_t kAmpClass = 1;
+        const uint16_t kEqualClass = 2;
+    }
+
+    KeyAutomaton::KeyAutomaton()
+    {
+        Build(KeyItems());
+    }
+
+    KeyAutomaton::KeyAutomaton( const KeyItems& keys )
+    {
+        Build(keys);
+    }
+
+    uint32_t KeyAutomaton::AddState()
+    {
+        uint32_t state = static_cast<uint32_t>(state_count());
+        table_.resize(table_.size() + class_count_, kDead);
+        // '&' ends the parameter from anywhere, the next one starts at the root
+        table_[state * class_count_ + kAmpClass] = kRoot;
+        return state;
+    }
+
+    void KeyAutomaton::Build( const KeyItems& keys )
+    {
+        std::fill(classes_, classes_ + 256, kOtherClass);
+        classes_[static_cast<uint8_t>('&')] = kAmpClass;
+        classes_[static_cast<uint8_t>('=')] = kEqualClass;
+        class_count_ = kEqualClass + 1;
+
+        std::vector<const std::string*> usable;
+        for (KeyItems::const_iterator it = keys.begin(); it != keys.end(); ++it)
+        {
+            if (it->find_first_of("&=") != std::string::npos)
+            {
+                continue;
+            }
+            usable.push_back(&*it);
+            for (size_t i = 0; i < it->size(); ++i)
+            {
+                uint8_t c = static_cast<uint8_t>((*it)[i]);
+                if (classes_[c] == kOtherClass)
+                {
+                    classes_[c] = static_cast<uint16_t>(class_count_++);
+                }
+            }
+        }
+
+        table_.clear();
+        AddState();     // kDead
+        AddState();     // kMatch
+        AddState();     // kRoot
+        // nothing leaves these two in the table, the scan handles them
+        table_[kDead * class_count_ + kAmpClass] = kDead;
+        table_[kMatch * class_count_ + kAmpClass] = kDead;
+
+        for (size_t k = 0; k < usable.size(); ++k)
+        {
+            const std::string& key = *usable[k];
+            uint32_t state = kRoot;
+            for (size_t i = 0; i < key.size(); ++i)
+            {
+                size_t column = classes_[static_cast<uint8_t>(key[i])];
+                uint32_t next = table_[state * class_count_ + column];
+                if (next == kDead)
+                {
+                    next = AddState();
+                    table_[state * class_count_ + column] = next;
+                }
+                state = next;
+            }
+            table_[state * class_count_ + kEqualClass] = kMatch;
+        }
+    }
+
+    bool KeyAutomaton::Find( const char* url, size_t len, Span* value ) const
+    {
+        const char* end = url + len;
+        const char* p = static_cast<const char*>(memchr(url, '?', len));
+        if (!p)
+        {
+            return false;
+        }
+        ++p;
+
+        const uint32_t* table = &table_[0];
+        uint32_t state = kRoot;
+        while (p < end)
+        {
+            state = table[state * class_count_ + classes_[static_cast<uint8_t>(*p++)]];
+            if (state == kMatch)
+            {
+                const char* value_end = static_cast<const char*>(memchr(p, '&', end - p));
+                if (!value_end)
+                {
+                    value_end = end;
+                }
+                if (value_end != p)
+                {
+                    value->data = p;
+                    value->len = value_end - p;
+                    return true;
+                }
+                // "key=" without a value, the next parameter may still match
+                if (value_end == end)
+                {
+                    return false;
+                }
+                p = value_end + 1;
+                state = kRoot;
+            }
+            else if (state == kDead)
+            {
+                p = static_cast<const char*>(memchr(p, '&', end - p));
+                if (!p)
+                {
+                    return false;
+                }
+                ++p;
+                state = kRoot;
+            }
+        }
+        return false;
+    }
+
+    void KeyAutomaton::Extract( const std::string& raw_url, std::string& sub_url ) const
+    {
+        Span value;
+        if (Find(raw_url.data(), raw_url.size(), &value))
+        {
+            sub_url.assign(value.data, value.len);
+        }
+        else
+        {
+            sub_url.clear();
+        }
+    }
+
+    std::string KeyAutomaton::Extract( const std::string& raw_url ) const
+    {
+        std::string sub_url;
+        Extract(raw_url, sub_url);
+        return sub_url;
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef PROXY_URL_KEY_AUTOMATON_H_
+#define PROXY_URL_KEY_AUTOMATON_H_
+
+#include <stdint.h>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "tokener.h"
+
+namespace qh
+{
+    /**
+    * All proxy keys, each followed by '=', compiled into one DFA that finds
+    * the sub url in a single pass over the query, with the same result as
+    * ProxyURLExtractor::Extract(keys, url).
+    *
+    * Matches only count at parameter boundaries, right after the first '?'
+    * or after a '&'. That anchoring makes every failure transition of the
+    * Aho-Corasick automaton of the patterns trivial: a byte that leaves the
+    * trie can only resume at the next '&', which the scan finds with memchr.
+    * What remains is the trie of the keys as a dense transition table, one
+    * row per state and one column per byte class. Bytes that appear in no
+    * key share a class, so the table stays small with thousands of keys.
+    *
+    * Keys containing '=' or '&' can never name a parameter and are dropped.
+    */
+    class KeyAutomaton
+    {
+    public:
+        typedef std::set<std::string> KeyItems;    //! the same as KeyItems
+
+    public:
+        KeyAutomaton();
+        explicit KeyAutomaton(const KeyItems& keys);
+
+        //! \brief Replace the keys
+        void Build(const KeyItems& keys);
+
+        //! \brief Find the value of the first parameter named by a key that has a value
+        //! \param[out] - Span * value - a slice of url, set only on success
+        //! \return - bool - whether there is one
+        bool Find(const char* url, size_t len, Span* value) const;
+
+        void Extract(const std::string& raw_url, std::string& sub_url) const;
+        std::string Extract(const std::string& raw_url) const;
+
+        //! \brief Number of rows of the transition table
+        size_t state_count() const
+        {
+            return class_count_ ? table_.size() / class_count_ : 0;
+        }
+
+        size_t class_count() const
+        {
+            return class_count_;
+        }
+
+    private:
+        enum
+        {
+            kDead = 0,      //! inside a parameter that can not match any more
+            kMatch = 1,     //! just read "key="
+            kRoot = 2,      //! at a parameter boundary
+        };
+
+        uint32_t AddState();
+
+    private:
+        uint16_t                classes_[256];  //! byte to column, up to 3 + 254 of them
+        size_t                  class_count_;
+        std::vector<uint32_t>   table_;         //! state * class_count_ + class to state
+    };
+}
+
+#endif //PROXY_URL_KEY_AUTOMATON_H_
@@ -1,62 +1,23 @@
 
 #include "proxy_url_extractor.h"
 #include <fstream>
-#include <vector>
+#include "qh_metrics.h"
+#include "qh_small_vector.h"
+#include "string_split.h"
 #include "tokener.h"
 
 namespace qh
 {
-
-    namespace {
-
-        template< class _StringVector, 
-        class StringType,
-        class _DelimType> 
-            inline void StringSplit(  
-            const StringType& str, 
-            const _DelimType& delims, 
-            unsigned int maxSplits, 
-            _StringVector& ret)
-        {
-            unsigned int numSplits = 0;
-
-            // Use STL methods
-            size_t start, pos;
-            start = 0;
-
-            do
-            {
-                pos = str.find_first_of( delims, start );
-
-                if ( pos == start )
-                {
-                    ret.push_back(StringType());
-                    start = pos + 1;
-                }
-                else if ( pos == StringType::npos || ( maxSplits && numSplits + 1== maxSplits ) )
-                {
-                    // Copy the rest of the string
-                    ret.push_back(StringType());
-                    *(ret.rbegin()) = StringType(str.data() + start, str.size() - start);
-                    break;
-                }
-                else
-                {
-                    // Copy up to delimiter
-                    //ret.push_back( str.substr( start, pos - start ) );
-                    ret.push_back(StringType());
-                    *(ret.rbegin()) = StringType(str.data() + start, pos - start);
-                    start = pos + 1;
-                }
-
-                ++numSplits;
-
-            }
-            while ( pos != StringType::npos );
-        }
+    namespace
+    {
+        metrics::Histogram g_extract_ns("proxy_url.extract.ns");
+        metrics::Counter g_extract_hits("proxy_url.extract.hits");
+        metrics::Counter g_extract_misses("proxy_url.extract.misses");
+        metrics::Counter g_extract_bytes("proxy_url.extract.bytes_scanned");
     }
 
     ProxyURLExtractor::ProxyURLExtractor()
+        : find_(NULL)
     {
     }
 
@@ -64,7 +25,8 @@ namespace qh
     {
         std::ifstream ifs;
         ifs.open(param_keys_path.data(), std::fstream::in);
-        typedef std::vector<std::string> stringvector;
+        // a rule line holds a few keys, keep them off the heap
+        typedef qh::small_vector<std::string, 8> stringvector;
         stringvector keysvect;
         
         while (!ifs.eof()) {
@@ -85,54 +47,81 @@ namespace qh
         }
 
         ifs.close();
+        automaton_.Build(keys_set_);
+        find_ = NULL;
 
         return true;
     }
 
     std::string ProxyURLExtractor::Extract( const std::string& raw_url )
     {
+        // the same answer as Extract(keys_set_, raw_url), in one pass
+        metrics::ScopedTimer timer(g_extract_ns);
         std::string sub_url;
-        ProxyURLExtractor::Extract(keys_set_, raw_url, sub_url);
+        Span value;
+        bool found = find_ ? find_(raw_url.data(), raw_url.size(), &value)
+            : automaton_.Find(raw_url.data(), raw_url.size(), &value);
+        if (found)
+        {
+            sub_url.assign(value.data, value.len);
+            g_extract_hits.Add();
+            g_extract_bytes.Add(value.data + value.len - raw_url.data());
+        }
+        else
+        {
+            g_extract_misses.Add();
+            g_extract_bytes.Add(raw_url.size());
+        }
         return sub_url;
     }
 
     void ProxyURLExtractor::Extract( const KeyItems& keys, const std::string& raw_url, std::string& sub_url )
     {
-#if 1
-        //TODO ԼĴʵ蹦
-#else
-        //һݲοʵ֣¹ܷԤ
+        metrics::ScopedTimer timer(g_extract_ns);
+        sub_url.clear();
+
         Tokener token(raw_url);
-        token.skipTo('?');
-        token.next(); //skip one char : '?' 
+        if (!token.skipTo('?'))
+        {
+            g_extract_misses.Add();
+            g_extract_bytes.Add(raw_url.size());
+            return;
+        }
+        token.next(); //skip one char : '?'
+
+        // the parameters are sliced out of raw_url, only a key that reaches
+        // the set lookup is copied, into a string reused across parameters
         std::string key;
-        while (!token.isEnd()) {
-            key = token.nextString('=');
-            if (keys.find(key) != keys.end()) {
-                const char* curpos = token.getCurReadPos();
-                int nreadable = token.getReadableSize();
+        Span param;
+        while (token.nextSpanUntil('&', &param))
+        {
+            Tokener kv(param.data, param.len);
+            Span name;
+            if (!kv.nextSpan('=', &name))
+            {
+                continue;
+            }
 
+            key.assign(name.data, name.len);
+            if (keys.find(key) != keys.end() && !kv.isEnd())
+            {
                 /**
-                * case 1: 
+                * case 1:
                 *  raw_url="http://www.microsofttranslator.com/bv.aspx?from=&to=zh-chs&a=http://hnujug.com/&xx=yy"
                 *  sub_url="http://hnujug.com/"
+                * case 2:
+                *  raw_url="http://www.microsofttranslator.com/bv.aspx?from=&to=zh-chs&a=http://hnujug.com/"
+                *  sub_url="http://hnujug.com/"
                 */
-                sub_url = token.nextString('&');
-
-                if (sub_url.empty() && nreadable > 0) {
-                    /**
-                    * case 2: 
-                    * raw_url="http://www.microsofttranslator.com/bv.aspx?from=&to=zh-chs&a=http://hnujug.com/"
-                    * sub_url="http://hnujug.com/"
-                    */
-                    assert(curpos);
-                    sub_url.assign(curpos, nreadable);
-                }
+                sub_url.assign(kv.getCurReadPos(), kv.getReadableSize());
+                g_extract_hits.Add();
+                // up to the end of the value, as Extract(url) counts
+                g_extract_bytes.Add(param.data + param.len - raw_url.data());
+                return;
             }
-            token.skipTo('&');
-            token.next();//skip one char : '&'
         }
-#endif
+        g_extract_misses.Add();
+        g_extract_bytes.Add(raw_url.size());
     }
 
     std::string ProxyURLExtractor::Extract( const KeyItems& keys, const std::string& raw_url )
@@ -4,7 +4,8 @@
 
 #include <string>
 #include <set>
-#include <set>
+
+#include "key_automaton.h"
 
 namespace qh
 {
@@ -17,7 +18,8 @@ namespace qh
     class ProxyURLExtractor
     {
     public:
-        typedef std::set<std::string/*proxy key*/> KeyItems;
+        typedef KeyAutomaton::KeyItems KeyItems;
+        typedef bool (*Finder)(const char* url, size_t len, Span* value);
 
     public:
         ProxyURLExtractor();
@@ -27,6 +29,17 @@ namespace qh
         //! \return - bool
         bool Initialize(const std::string& rule_file);
 
+        //! \brief Use keys built in at compile time instead of a rule file,
+        //!   Extract(url) then runs StaticKeys::Find. See StaticKeySet.
+        template<class StaticKeys>
+        void Initialize()
+        {
+            keys_set_.clear();
+            StaticKeys::CopyTo(keys_set_);
+            automaton_.Build(keys_set_);
+            find_ = &StaticKeys::Find;
+        }
+
         //! \brief ȡurlȡʧܣؿմ
         //! \param[in] - const std::string & url
         //! \return - std::string
@@ -38,6 +51,8 @@ namespace qh
     private:
 
         KeyItems keys_set_;
+        KeyAutomaton automaton_;    //! keys_set_ compiled, Extract(url) runs it
+        Finder find_;               //! a StaticKeySet that Extract(url) runs instead, or NULL
     };
 }
 
@@ -0,0 +1,210 @@
+#ifndef PROXY_URL_STATIC_KEY_SET_H_
+#define PROXY_URL_STATIC_KEY_SET_H_
+
+#include <string.h>
+#include <algorithm>
+#include <array>
+#include <set>
+#include <string>
+#include <utility>
+
+#include "tokener.h"
+
+namespace qh
+{
+    namespace detail
+    {
+        constexpr size_t KeyLength(const char* s)
+        {
+            return *s ? 1 + KeyLength(s + 1) : 0;
+        }
+
+        //! \brief Whether s can name a parameter
+        constexpr bool IsProxyKey(const char* s)
+        {
+            for (size_t i = 0; s[i]; ++i)
+            {
+                if (s[i] == '=' || s[i] == '&')
+                {
+                    return false;
+                }
+            }
+            return *s != '\0';
+        }
+
+        //! \brief The bytes keys start with
+        struct FirstBytes
+        {
+            bool bytes[256];
+        };
+
+        template<const char*... Keys>
+        constexpr FirstBytes MakeFirstBytes()
+        {
+            FirstBytes first = {};
+            ((first.bytes[static_cast<unsigned char>(Keys[0])] = true), ...);
+            return first;
+        }
+    }
+
+    /**
+    * A proxy key set fixed at compile time, for deployments that build the
+    * keys in instead of loading a rule file. Extract() gives the same result
+    * as ProxyURLExtractor::Extract(keys, url) for the same keys, and
+    * ProxyURLExtractor::Initialize<Keys>() runs it behind Extract(url).
+    *
+    * A parameter whose first byte starts no key, or whose name runs past the
+    * longest key, is skipped with memchr right away. Any other name is
+    * dispatched on its length through a table built at compile time, and
+    * only the keys of that length are compared, each with a constant size
+    * memcmp that folds into a few loads.
+    *
+    * The keys must be objects with linkage, e.g.
+    *     inline constexpr char kUrl[] = "url";
+    *     typedef StaticKeySet<kUrl, ...> MyKeys;
+    */
+    template<const char*... Keys>
+    class StaticKeySet
+    {
+    public:
+        static_assert(sizeof...(Keys) > 0, "a StaticKeySet needs keys");
+        static_assert((detail::IsProxyKey(Keys) && ...), "keys are not empty and hold neither '=' nor '&'");
+
+        //! \brief Whether [name, name + len) is one of the keys
+        static bool Contains(const char* name, size_t len)
+        {
+            return len <= kMaxLength && kByLength[len](name);
+        }
+
+        //! \brief Find the value of the first parameter named by a key that has a value
+        //! \param[out] - Span * value - a slice of url, set only on success
+        //! \return - bool - whether there is one
+        static bool Find(const char* url, size_t len, Span* value)
+        {
+            const char* end = url + len;
+            const char* param = static_cast<const char*>(memchr(url, '?', len));
+            if (!param)
+            {
+                return false;
+            }
+            for (++param; param < end; )
+            {
+                const char* name_end = param;
+                if (kFirstBytes.bytes[static_cast<unsigned char>(*param)])
+                {
+                    // a key name ends within kMaxLength + 1 bytes or not at all
+                    const char* limit = static_cast<size_t>(end - param) > kMaxLength ? param + kMaxLength + 1 : end;
+                    while (name_end < limit && *name_end != '=' && *name_end != '&')
+                    {
+                        ++name_end;
+                    }
+                    if (name_end < limit && *name_end == '=')
+                    {
+                        const char* amp = static_cast<const char*>(memchr(name_end, '&', end - name_end));
+                        amp = amp ? amp : end;
+                        if (amp - name_end > 1 && Contains(param, name_end - param))
+                        {
+                            value->data = name_end + 1;
+                            value->len = amp - name_end - 1;
+                            return true;
+                        }
+                        if (amp == end)
+                        {
+                            return false;
+                        }
+                        param = amp + 1;
+                        continue;
+                    }
+                }
+                param = static_cast<const char*>(memchr(name_end, '&', end - name_end));
+                if (!param)
+                {
+                    return false;
+                }
+                ++param;
+            }
+            return false;
+        }
+
+        static void Extract(const std::string& raw_url, std::string& sub_url)
+        {
+            Span value;
+            if (Find(raw_url.data(), raw_url.size(), &value))
+            {
+                sub_url.assign(value.data, value.len);
+            }
+            else
+            {
+                sub_url.clear();
+            }
+        }
+
+        static std::string Extract(const std::string& raw_url)
+        {
+            std::string sub_url;
+            Extract(raw_url, sub_url);
+            return sub_url;
+        }
+
+        //! \brief Add the keys to a KeyItems
+        static void CopyTo(std::set<std::string>& keys)
+        {
+            (keys.insert(Keys), ...);
+        }
+
+        static constexpr size_t size()
+        {
+            return sizeof...(Keys);
+        }
+
+    private:
+        typedef bool (*Matcher)(const char* name);
+
+        static constexpr size_t kMaxLength = std::max({detail::KeyLength(Keys)...});
+        static constexpr detail::FirstBytes kFirstBytes = detail::MakeFirstBytes<Keys...>();
+
+        template<size_t Len, const char* Key>
+        static bool Equal(const char* name)
+        {
+            if constexpr (detail::KeyLength(Key) == Len)
+            {
+                return memcmp(name, Key, Len) == 0;
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        //! \brief Whether a name of Len bytes is a key, compares only the keys of that length
+        template<size_t Len>
+        static bool MatchLength(const char* name)
+        {
+            return (Equal<Len, Keys>(name) || ...);
+        }
+
+        template<size_t... Lens>
+        static constexpr std::array<Matcher, sizeof...(Lens)> MakeByLength(std::index_sequence<Lens...>)
+        {
+            return {{&MatchLength<Lens>...}};
+        }
+
+        static constexpr std::array<Matcher, kMaxLength + 1> kByLength = MakeByLength(std::make_index_sequence<kMaxLength + 1>());
+    };
+
+    namespace static_keys
+    {
+        inline constexpr char kA[] = "a";
+        inline constexpr char kU[] = "u";
+        inline constexpr char kUrl[] = "url";
+        inline constexpr char kCurl[] = "curl";
+        inline constexpr char kQuery[] = "query";
+        inline constexpr char kUri[] = "uri";
+    }
+
+    //! The keys the unit tests and benches use: a, u, url, curl, query, uri
+    typedef StaticKeySet<static_keys::kA, static_keys::kU, static_keys::kUrl,
+        static_keys::kCurl, static_keys::kQuery, static_keys::kUri> DefaultStaticKeySet;
+}
+
+#endif //PROXY_URL_STATIC_KEY_SET_H_
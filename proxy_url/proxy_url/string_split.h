@@ -0,0 +1,59 @@
+#ifndef PROXY_URL_STRING_SPLIT_H_
+#define PROXY_URL_STRING_SPLIT_H_
+
+#include <stddef.h>
+
+namespace qh
+{
+    /**
+    * Split str at any of the characters in delims and append the pieces to ret.
+    * Empty pieces are kept. If maxSplits is not 0, at most maxSplits pieces are
+    * produced and the last one holds the rest of str.
+    * ret only needs push_back and back(), so a qh::small_vector keeps the
+    * usual handful of pieces off the heap.
+    */
+    template< class _StringVector, 
+    class StringType,
+    class _DelimType> 
+        inline void StringSplit(  
+        const StringType& str, 
+        const _DelimType& delims, 
+        unsigned int maxSplits, 
+        _StringVector& ret)
+    {
+        unsigned int numSplits = 0;
+
+        // Use STL methods
+        size_t start, pos;
+        start = 0;
+
+        do
+        {
+            pos = str.find_first_of( delims, start );
+
+            if ( pos == start )
+            {
+                ret.push_back(StringType());
+                start = pos + 1;
+            }
+            else if ( pos == StringType::npos || ( maxSplits && numSplits + 1== maxSplits ) )
+            {
+                // Copy the rest of the string
+                ret.push_back(StringType(str.data() + start, str.size() - start));
+                break;
+            }
+            else
+            {
+                // Copy up to delimiter
+                ret.push_back(StringType(str.data() + start, pos - start));
+                start = pos + 1;
+            }
+
+            ++numSplits;
+
+        }
+        while ( pos != StringType::npos );
+    }
+}
+
+#endif //PROXY_URL_STRING_SPLIT_H_
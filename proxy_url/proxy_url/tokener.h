@@ -9,10 +9,35 @@ namespace qh
 {
     typedef unsigned int u32;
     typedef int s32;
+    typedef unsigned long long u64;
+    typedef long long s64;
+
+    /**
+    * A slice of a Tokener's source. It does not own the characters, so it is
+    * valid only as long as the source buffer is.
+    */
+    struct Span
+    {
+        const char* data;
+        size_t      len;
+
+        bool empty() const { return len == 0; }
+        std::string str() const { return std::string(data, len); }
+    };
 
     /**
     * A Tokener takes a source string and extracts characters and tokens from
     * it. It is used help to parse strings.
+    *
+    * Sizes and positions are 64 bit, so a Tokener can walk an mmapped file
+    * larger than 2GB. The end of the source is only ever known from its
+    * length: a NUL byte inside [data(), data() + size()) is an ordinary
+    * character. skipTo(), skipBackTo() and nextString(quote) scan with
+    * memchr()/memrchr() instead of one next() per character.
+    *
+    * The nextSpan() family returns slices of the source instead of new
+    * std::string objects and reports failure only through its return value,
+    * so tokenizing allocates nothing. nextString() wraps them.
     * @version 2009-11-11
     */
     class Tokener
@@ -32,12 +57,13 @@ namespace qh
 
         Tokener( const std::string& s );
 
-        Tokener( const char* ps, const s32 ps_len = -1);
+        Tokener( const char* ps, const s64 ps_len = -1);
 
         /**
         * Calling this method is similar to reconstruct a new Tokener
+        * @param ps_len The length of ps, or -1 to take strlen(ps)
         */
-        void reset(const char* ps, const s32 ps_len = -1);
+        void reset(const char* ps, const s64 ps_len = -1);
 
         ~Tokener();
 
@@ -52,7 +78,7 @@ namespace qh
         * Back up several characters.
         * @param backstep - The count of back up steps
         */
-        bool back(int backstep);
+        bool back(s64 backstep);
 
         /**
         * Get the next character in the source string.
@@ -95,14 +121,34 @@ namespace qh
         */
         std::string nextString();
 
+        /**
+        * Get the characters up to the next character <code>quote</code> and
+        * skip the quote.
+        * @return false if <code>quote</code> is not found, nothing is skipped then
+        */
+        bool nextSpan( char quote, Span* span );
+
+        /**
+        * Get the characters up to the next white space( or tab, \n, \r, \0 )
+        * character and skip the white space.
+        * @return false if it is the end of the string
+        */
+        bool nextSpan( Span* span );
+
+        /**
+        * Get the characters up to the next character <code>sep</code> or up to
+        * the end of the string, and skip the sep. Splits "a&b&c" into fields.
+        * @return false if it is the end of the string
+        */
+        bool nextSpanUntil( char sep, Span* span );
+
         /**
         * Skip characters until the next character is the requested character.
         * If the requested character is not found, no characters are skipped.
-        * @param to A character to skip to.
-        * @return The requested character, or zero if the requested character
-        * is not found.
+        * @param to A character to skip to, '\0' included.
+        * @return true if it is found, even at the current position.
         */
-        char skipTo( char to );
+        bool skipTo( char to );
 
 
         /**
@@ -115,11 +161,10 @@ namespace qh
         /**
         * Skip characters until the previous character is the requested character.
         * If the requested character is not found, no characters are skipped.
-        * @param to A character to skip to.
-        * @return The requested character, or zero if the requested character
-        * is not found.
+        * @param to A character to skip to, '\0' included.
+        * @return true if it is found.
         */
-        char skipBackTo( char to );
+        bool skipBackTo( char to );
 
         /**
         * Skip all whitespace, tab, \n
@@ -137,7 +182,7 @@ namespace qh
         static int dehexchar( char c );
 
         /** Gets current read position in the buffer. It also serve as length of buffer parsed. */
-        u32 getCurPos() const
+        u64 getCurPos() const
         {
             return m_pCurPos - m_pData;
         }
@@ -151,20 +196,20 @@ namespace qh
         /** Query whether it is the end of the string.*/
         bool isEnd() const
         {
-            return ( m_pCurPos >= m_pDataEnd || *m_pCurPos == '\0' );
+            return m_pCurPos >= m_pDataEnd;
         }
 
         /** Gets size of data that can read from the current read position. */
-        s32 getReadableSize() const
+        s64 getReadableSize() const
         {
-            return (s32)(m_pDataEnd - m_pCurPos);
+            return (s64)(m_pDataEnd - m_pCurPos);
         }
 
         const char* data() const { return m_pData;}
         size_t size() const { return m_pDataEnd - m_pData;}
 
     protected:
-        void setCurrentPos( u32 icurentpos )
+        void setCurrentPos( u64 icurentpos )
         {
             m_pCurPos = icurentpos + m_pData;
         }
@@ -182,24 +227,29 @@ namespace qh
 
     inline Tokener::Tokener( const std::string& s )
     {
-        reset(s.c_str(), s.length());
+        reset(s.data(), (s64)s.length());
     }
 
-    inline Tokener::Tokener( const char* ps, const s32 len )
+    inline Tokener::Tokener( const char* ps, const s64 len )
     {
         reset(ps, len);
     }
 
-    inline void Tokener::reset( const char* ps, const s32 len )
+    inline void Tokener::reset( const char* ps, const s64 len )
     {
-        m_pDataEnd = len + ps; 
-        if ( len < 0 && ps )
+        //! resolve the length before forming ps + len, ps - 1 is undefined
+        size_t size = 0;
+        if ( !ps )
         {
-            m_pDataEnd = ps + strlen( ps );
+            ps = "";
         }
-
-        m_pData   = const_cast<const char*>( ps );
-        m_pCurPos = m_pData;
+        else
+        {
+            size = len < 0 ? strlen( ps ) : static_cast<size_t>( len );
+        }
+        m_pData    = ps;
+        m_pDataEnd = ps + size;
+        m_pCurPos  = m_pData;
     }
     //----------------------------------------------------------------------------
     inline Tokener::~Tokener()
@@ -211,7 +261,6 @@ namespace qh
     {
         if ( m_pCurPos <= m_pData )
         {
-            fprintf(stderr, "Stepping back two steps is not supported\n" );
             return false;
         }
 
@@ -219,11 +268,10 @@ namespace qh
         return true;
     }
 
-    inline bool Tokener::back(int backstep)
+    inline bool Tokener::back(s64 backstep)
     {
-        if ( m_pCurPos - backstep < m_pData)
+        if ( backstep > m_pCurPos - m_pData )
         {
-            fprintf(stderr, "Stepping back two steps is not supported\n" );
             return false;
         }
 
@@ -294,89 +342,112 @@ namespace qh
     }
 
     inline std::string Tokener::nextString()
+    {
+        Span span;
+        return nextSpan( &span ) ? span.str() : std::string();
+    }
+
+    inline std::string Tokener::nextString( char quote )
+    {
+        Span span;
+        return nextSpan( quote, &span ) ? span.str() : std::string();
+    }
+
+    inline bool Tokener::nextSpan( Span* span )
     {
         if ( isEnd() )
         {
-            return "";
+            return false;
         }
 
-        const char* startpos = m_pCurPos;
-
-        for ( unsigned char c = 0; m_pCurPos < m_pDataEnd; )
+        const char* p = m_pCurPos;
+        while ( p < m_pDataEnd && (unsigned char)*p > ' ' )
         {
-            c = *m_pCurPos++;
-
-            if (c <= ' ')
-            {
-                return std::string( startpos, m_pCurPos - startpos - 1);
-            }
-
-            if (isEnd())
-            {
-                return std::string( startpos, m_pDataEnd - startpos );
-            }
+            ++p;
         }
 
-        assert(false && "Logic ERROR. The routine SHOULD NOT come there.");
-        return std::string();
+        span->data = m_pCurPos;
+        span->len = p - m_pCurPos;
+        //! skip the white space too
+        m_pCurPos = p < m_pDataEnd ? p + 1 : m_pDataEnd;
+        return true;
     }
 
-
-    inline std::string Tokener::nextString( char quote )
+    inline bool Tokener::nextSpan( char quote, Span* span )
     {
-        const char* startpos = m_pCurPos;
+        if ( isEnd() )
+        {
+            return false;
+        }
 
-        while ( *m_pCurPos++ != quote )
+        const char* pos = (const char*)memchr( m_pCurPos, quote, m_pDataEnd - m_pCurPos );
+        if ( !pos )
         {
-            if ( isEnd() )
-            {
-                m_pCurPos = startpos;
-                return std::string();
-            }
+            return false;
         }
 
-        assert( m_pCurPos > startpos );
-        return std::string( startpos, m_pCurPos - startpos - 1 );
+        span->data = m_pCurPos;
+        span->len = pos - m_pCurPos;
+        m_pCurPos = pos + 1;
+        return true;
     }
 
-    inline char Tokener::skipTo( char to )
+    inline bool Tokener::nextSpanUntil( char sep, Span* span )
     {
-        register char c = 0;
-        const char* startIndex = this->m_pCurPos;
+        if ( isEnd() )
+        {
+            return false;
+        }
 
-        do
+        const char* pos = (const char*)memchr( m_pCurPos, sep, m_pDataEnd - m_pCurPos );
+        span->data = m_pCurPos;
+        if ( pos )
+        {
+            span->len = pos - m_pCurPos;
+            m_pCurPos = pos + 1;
+        }
+        else
         {
-            c = next();
+            span->len = m_pDataEnd - m_pCurPos;
+            m_pCurPos = m_pDataEnd;
+        }
+        return true;
+    }
 
-            if ( c == 0 )
-            {
-                m_pCurPos = startIndex;
-                return c;
-            }
+    inline bool Tokener::skipTo( char to )
+    {
+        if ( isEnd() )
+        {
+            return false;
         }
-        while ( c != to );
 
-        back();
-        return c;
+        const char* pos = (const char*)memchr( m_pCurPos, to, m_pDataEnd - m_pCurPos );
+        if ( !pos )
+        {
+            return false;
+        }
+
+        m_pCurPos = pos;
+        return true;
     }
 
-    inline char Tokener::skipBackTo( char to )
+    inline bool Tokener::skipBackTo( char to )
     {
+        //! next() may have stepped past the end
+        const char* last = m_pCurPos < m_pDataEnd ? m_pCurPos : m_pDataEnd;
+        if ( last <= m_pData )
+        {
+            return false;
+        }
 
-        const char* startIndex = this->m_pCurPos;
-
-        do
+        const char* pos = (const char*)memrchr( m_pData, to, last - m_pData );
+        if ( !pos )
         {
-            if ( !back() )
-            {
-                m_pCurPos = startIndex;
-                return 0;
-            }
+            return false;
         }
-        while ( current() != to );
-        char c = current();
-        next();
-        return c;
+
+        m_pCurPos = pos + 1;
+        return true;
     }
 
     //--------------------------------------------------------------------------
@@ -409,8 +480,7 @@ namespace qh
         *  So, we just skipTo( 0x)0A )
         */
 
-        char c = skipTo( (char)0x0a ); 
-        if ( c == 0 )
+        if ( !skipTo( (char)0x0a ) )
         {
             return false;
         }
@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+
+#include "qh_bench.h"
+#include "qh_string.h"
+
+namespace
+{
+    const size_t kStringsPerRequest = 4096;
+    const size_t kRequests = 200;
+    const size_t kMaxLength = 64;
+
+    char g_text[kMaxLength];
+    size_t g_lengths[kStringsPerRequest];
+
+    void InitInput()
+    {
+        memset(g_text, 'q', sizeof(g_text));
+        unsigned int seed = 20140106;
+        for (size_t i = 0; i < kStringsPerRequest; ++i)
+        {
+            seed = seed * 1103515245 + 12345;
+            g_lengths[i] = 4 + (seed >> 16) % (kMaxLength - 4);
+        }
+    }
+
+    // Build one request worth of short-lived strings and destroy them all at the end,
+    // calling peak(mr) while they are still alive.
+    template<class Peak>
+    void OneRequest(qh::memory_resource* mr, Peak& peak)
+    {
+        static char storage[kStringsPerRequest * sizeof(qh::string)];
+        qh::string* strings = reinterpret_cast<qh::string*>(storage);
+        for (size_t i = 0; i < kStringsPerRequest; ++i)
+        {
+            new (strings + i) qh::string(g_text, g_lengths[i], mr);
+        }
+        qh::bench::DoNotOptimize(strings[kStringsPerRequest - 1].c_str());
+        peak(mr);
+        for (size_t i = 0; i < kStringsPerRequest; ++i)
+        {
+            strings[i].~string();
+        }
+    }
+
+    void NoPeak(qh::memory_resource*) {}
+
+    struct ArenaPeak
+    {
+        size_t allocated, reserved;
+        ArenaPeak() : allocated(0), reserved(0) {}
+        void operator()(qh::memory_resource* mr)
+        {
+            qh::arena_resource* arena = static_cast<qh::arena_resource*>(mr);
+            allocated = arena->bytes_allocated();
+            reserved = arena->bytes_reserved();
+        }
+    };
+
+    struct PoolPeak
+    {
+        size_t requested, in_use, reserved;
+        PoolPeak() : requested(0), in_use(0), reserved(0) {}
+        void operator()(qh::memory_resource* mr)
+        {
+            qh::pool_resource* pool = static_cast<qh::pool_resource*>(mr);
+            requested = pool->bytes_requested();
+            in_use = pool->bytes_in_use();
+            reserved = pool->bytes_reserved();
+        }
+    };
+}
+
+int main(int argc, char* argv[])
+{
+    InitInput();
+    const uint64_t ops = kStringsPerRequest * kRequests;
+
+    qh::bench::Run("string/new_delete", ops, []() {
+        for (size_t r = 0; r < kRequests; ++r)
+        {
+            OneRequest(qh::new_delete_resource(), NoPeak);
+        }
+    });
+
+    ArenaPeak arena_peak;
+    qh::bench::Run("string/arena", ops, [&arena_peak]() {
+        qh::arena_resource arena(64 * 1024);
+        for (size_t r = 0; r < kRequests; ++r)
+        {
+            OneRequest(&arena, arena_peak);
+            arena.release();
+        }
+    });
+    qh::bench::Report("string/arena", "peak bytes allocated", arena_peak.allocated);
+    qh::bench::Report("string/arena", "peak bytes reserved", arena_peak.reserved);
+
+    PoolPeak pool_peak;
+    qh::bench::Run("string/pool", ops, [&pool_peak]() {
+        qh::pool_resource pool;
+        for (size_t r = 0; r < kRequests; ++r)
+        {
+            OneRequest(&pool, pool_peak);
+        }
+    });
+    qh::bench::Report("string/pool", "peak bytes requested", pool_peak.requested);
+    qh::bench::Report("string/pool", "peak bytes in use", pool_peak.in_use);
+    qh::bench::Report("string/pool", "peak bytes reserved", pool_peak.reserved);
+    return 0;
+}
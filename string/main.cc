@@ -1,13 +1,274 @@
+#include <assert.h>
+#include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include "qh_string.h"
+#include "qh_metrics.h"
 
+#ifdef QH_ENABLE_METRICS
+#include <thread>
+#endif
+
+void test_ctor()
+{
+    qh::string empty;
+    assert(empty.size() == 0);
+    assert(strcmp(empty.c_str(), "") == 0);
+
+    qh::string null_str(static_cast<const char*>(NULL));
+    assert(null_str.size() == 0);
+
+    qh::string s("hello");
+    assert(s.size() == 5);
+    assert(strcmp(s.c_str(), "hello") == 0);
+    assert(memcmp(s.data(), "hello", 5) == 0);
+
+    qh::string part("hello world", 5);
+    assert(part.size() == 5);
+    assert(strcmp(part.c_str(), "hello") == 0);
+
+    size_t zero_len = 0;
+    qh::string zero("hello", zero_len);
+    assert(zero.size() == 0);
+    assert(strcmp(zero.c_str(), "") == 0);
+}
+
+void test_copy_and_assign()
+{
+    qh::string a("abc");
+    qh::string b(a);
+    assert(b.size() == 3);
+    assert(strcmp(b.c_str(), "abc") == 0);
+    assert(a.c_str() != b.c_str());
+
+    qh::string c("longer string");
+    c = a;
+    assert(c.size() == 3);
+    assert(strcmp(c.c_str(), "abc") == 0);
+
+    c = c;
+    assert(strcmp(c.c_str(), "abc") == 0);
+
+    qh::string empty;
+    c = empty;
+    assert(c.size() == 0);
+    assert(strcmp(c.c_str(), "") == 0);
+}
+
+void test_index()
+{
+    qh::string s("abc");
+    assert(*s[0] == 'a');
+    assert(*s[2] == 'c');
+    assert(s[3] == NULL);
+
+    *s[1] = 'x';
+    assert(strcmp(s.c_str(), "axc") == 0);
+
+    qh::string empty;
+    assert(empty[0] == NULL);
+}
+
+void test_arena_resource()
+{
+    qh::arena_resource arena(256);
+    {
+        qh::string a("arena", &arena);
+        qh::string b("another arena string", &arena);
+        assert(a.get_memory_resource() == &arena);
+        assert(strcmp(a.c_str(), "arena") == 0);
+        assert(strcmp(b.c_str(), "another arena string") == 0);
+        assert(arena.bytes_allocated() == 6 + 21);
+        assert(arena.block_count() == 1);
+
+        // copies go to the default resource unless told otherwise
+        qh::string heap_copy(a);
+        assert(heap_copy.get_memory_resource() == qh::get_default_resource());
+        qh::string arena_copy(a, &arena);
+        assert(arena_copy.get_memory_resource() == &arena);
+        assert(arena.bytes_allocated() == 6 + 21 + 6);
+
+        // assignment keeps the resource of the target
+        heap_copy = b;
+        assert(heap_copy.get_memory_resource() == qh::get_default_resource());
+        assert(strcmp(heap_copy.c_str(), "another arena string") == 0);
+    }
+
+    // a request larger than a block gets its own block
+    char big[1024];
+    memset(big, 'x', sizeof(big));
+    qh::string s(big, sizeof(big), &arena);
+    assert(s.size() == sizeof(big));
+    assert(arena.block_count() == 2);
+
+    arena.release();
+    assert(arena.bytes_allocated() == 0);
+    assert(arena.bytes_reserved() == 0);
+    assert(arena.block_count() == 0);
+}
+
+void test_pool_resource()
+{
+    qh::pool_resource pool;
+    const char* first = NULL;
+    {
+        qh::string a("pooled", &pool);
+        first = a.c_str();
+        assert(pool.bytes_requested() == 7);
+        assert(pool.bytes_in_use() == qh::pool_resource::kMinClassSize);
+    }
+    assert(pool.bytes_in_use() == 0);
+    assert(pool.bytes_requested() == 0);
+
+    // a freed chunk is recycled by the next request of the same class
+    qh::string b("recycled", &pool);
+    assert(b.c_str() == first);
+    assert(strcmp(b.c_str(), "recycled") == 0);
+
+    char big[8192];
+    memset(big, 'y', sizeof(big));
+    qh::string huge(big, sizeof(big), &pool);
+    assert(huge.size() == sizeof(big));
+    assert(pool.bytes_requested() == 9);
+}
+
+void test_default_resource()
+{
+    qh::arena_resource arena;
+    qh::memory_resource* old = qh::set_default_resource(&arena);
+    assert(old == qh::new_delete_resource());
+    {
+        qh::string s("default");
+        assert(s.get_memory_resource() == &arena);
+        assert(arena.bytes_allocated() == 8);
+    }
+    qh::set_default_resource(NULL);
+    assert(qh::get_default_resource() == qh::new_delete_resource());
+}
+
+void test_metrics_buckets()
+{
+    using namespace qh::metrics;
+    for (uint64_t v = 0; v < kSubBuckets; ++v)
+    {
+        assert(BucketOf(v) == v);
+        assert(BucketLowerBound(v) == v);
+    }
+    assert(BucketOf(8) == 8 && BucketOf(15) == 15);
+    assert(BucketOf(16) == 16 && BucketOf(17) == 16 && BucketOf(18) == 17);
+    assert(BucketOf(~0ULL) == kBuckets - 1);
+
+    // every bucket starts where the previous one ends, within 12.5%
+    for (size_t b = 1; b < kBuckets; ++b)
+    {
+        uint64_t low = BucketLowerBound(b);
+        assert(low > BucketLowerBound(b - 1));
+        assert(BucketOf(low) == b);
+        assert(BucketOf(low - 1) == b - 1);
+        assert(b < kSubBuckets || (low - BucketLowerBound(b - 1)) * 8 <= low);
+    }
+
+    HistogramSnapshot h;
+    h.count = 0;
+    h.sum = 0;
+    assert(h.Percentile(0.5) == 0);
+    h.buckets.assign(kBuckets, 0);
+    h.buckets[BucketOf(10)] = 90;
+    h.buckets[BucketOf(1000)] = 10;
+    h.count = 100;
+    h.sum = 90 * 10 + 10 * 1000;
+    assert(h.Percentile(0.0) == 10);
+    assert(h.Percentile(0.5) == 10);
+    assert(h.Percentile(0.95) == BucketLowerBound(BucketOf(1000)));
+    assert(h.Mean() == 109.0);
+}
+
+#ifdef QH_ENABLE_METRICS
+void test_metrics()
+{
+    static qh::metrics::Counter counter("test.counter");
+    static qh::metrics::Histogram histogram("test.histogram");
+    assert(qh::metrics::Enabled());
+
+    counter.Add();
+    counter.Add(41);
+    histogram.Record(5);
+
+    // recorded by threads that are gone by the time of the snapshot
+    std::thread workers[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        workers[i] = std::thread([] {
+            for (int j = 0; j < 1000; ++j)
+            {
+                counter.Add();
+                qh::metrics::ScopedTimer timer(histogram);
+            }
+        });
+    }
+    for (int i = 0; i < 4; ++i)
+    {
+        workers[i].join();
+    }
+
+    qh::metrics::Snapshot snapshot = qh::metrics::TakeSnapshot();
+    assert(snapshot.Counter("test.counter") == 4042);
+    assert(snapshot.Counter("no.such.counter") == 0);
+    const qh::metrics::HistogramSnapshot* h = snapshot.Histogram("test.histogram");
+    assert(h && h->count == 4001);
+    assert(h->buckets[5] >= 1);
+    assert(!snapshot.Histogram("no.such.histogram"));
+
+    // a second snapshot sees the same totals
+    assert(qh::metrics::TakeSnapshot().Counter("test.counter") == 4042);
+}
+
+void test_heap_metrics()
+{
+    qh::metrics::Snapshot before = qh::metrics::TakeSnapshot();
+    {
+        qh::string s("counted");
+        qh::arena_resource arena(4096);
+        qh::string a("on the arena", &arena);
+    }
+    qh::metrics::Snapshot after = qh::metrics::TakeSnapshot();
+
+    // one for the heap string, one for the arena's block
+    assert(after.Counter("memory.heap.allocations") - before.Counter("memory.heap.allocations") == 2);
+    assert(after.Counter("memory.heap.deallocations") - before.Counter("memory.heap.deallocations") == 2);
+    assert(after.Counter("memory.heap.bytes") - before.Counter("memory.heap.bytes") >= 4096 + 8);
+}
+#else
+void test_metrics()
+{
+    // compiled out: nothing is registered and the snapshot stays empty
+    static qh::metrics::Counter counter("test.counter");
+    counter.Add();
+    assert(!qh::metrics::Enabled());
+    assert(qh::metrics::TakeSnapshot().counters.empty());
+    assert(qh::metrics::TakeSnapshot().histograms.empty());
+}
+
+void test_heap_metrics()
+{
+}
+#endif
 
 int main(int argc, char* argv[])
 {
     //TODO ӵԪԣԽԽã·ԽȫԽ
     //TODO ԪдοINIParserǸĿҪдһprintfҪassertжжϡ
 
+    test_ctor();
+    test_copy_and_assign();
+    test_index();
+    test_arena_resource();
+    test_pool_resource();
+    test_default_resource();
+    test_metrics_buckets();
+    test_metrics();
+    test_heap_metrics();
+
 #ifdef WIN32
     system("pause");
 #endif
@@ -1,37 +1,58 @@
 #include "qh_string.h"
 
+#include <assert.h>
 #include <string.h>
 
 namespace qh
 {
-    // TODO дʵִ
-
-    string::string()
-        : data_(NULL), len_(0)
+    string::string(memory_resource* mr)
+        : data_(NULL), len_(0), resource_(mr ? mr : get_default_resource())
     {
     }
 
-    string::string( const char* s )
+    string::string( const char* s, memory_resource* mr )
+        : data_(NULL), len_(0), resource_(mr ? mr : get_default_resource())
     {
+        if (s)
+        {
+            assign(s, strlen(s));
+        }
     }
 
-    string::string( const char* s, size_t len )
+    string::string( const char* s, size_t len, memory_resource* mr )
+        : data_(NULL), len_(0), resource_(mr ? mr : get_default_resource())
     {
+        if (s)
+        {
+            assign(s, len);
+        }
     }
 
     string::string( const string& rhs )
+        : data_(NULL), len_(0), resource_(get_default_resource())
     {
+        assign(rhs.data_, rhs.len_);
+    }
 
+    string::string( const string& rhs, memory_resource* mr )
+        : data_(NULL), len_(0), resource_(mr ? mr : get_default_resource())
+    {
+        assign(rhs.data_, rhs.len_);
     }
 
     string& string::operator=( const string& rhs )
     {
+        if (this != &rhs)
+        {
+            release();
+            assign(rhs.data_, rhs.len_);
+        }
         return *this;
     }
 
     string::~string()
     {
-
+        release();
     }
 
     size_t string::size() const
@@ -41,16 +62,50 @@ namespace qh
 
     const char* string::data() const
     {
-        return NULL;
+        return data_;
     }
 
     const char* string::c_str() const
     {
-        return NULL;
+        return data_ ? data_ : "";
+    }
+
+    memory_resource* string::get_memory_resource() const
+    {
+        return resource_;
     }
 
     char* string::operator[]( size_t index )
     {
-        return NULL;
+        if (index >= len_)
+        {
+            return NULL;
+        }
+        return data_ + index;
+    }
+
+    void string::assign( const char* s, size_t len )
+    {
+        assert(data_ == NULL);
+        if (len == 0)
+        {
+            return;
+        }
+
+        // Characters need no alignment, which lets an arena pack strings tightly
+        data_ = static_cast<char*>(resource_->allocate(len + 1, 1));
+        memcpy(data_, s, len);
+        data_[len] = '\0';
+        len_ = len;
+    }
+
+    void string::release()
+    {
+        if (data_)
+        {
+            resource_->deallocate(data_, len_ + 1, 1);
+            data_ = NULL;
+            len_ = 0;
+        }
     }
 }
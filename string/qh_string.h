@@ -3,16 +3,21 @@
 
 #include <stdlib.h>
 
+#include "qh_memory_resource.h"
+
 namespace qh
 {
     class string {
     public:
         //ctor
-        string();
-        string(const char* s);
-        string(const char* s, size_t len);
+        //! \param[in] - memory_resource * mr - where the buffer lives, NULL means get_default_resource()
+        explicit string(memory_resource* mr = NULL);
+        string(const char* s, memory_resource* mr = NULL);
+        string(const char* s, size_t len, memory_resource* mr = NULL);
         string(const string& rhs);
+        string(const string& rhs, memory_resource* mr);
 
+        //! \brief Copies the characters, *this keeps its own memory resource
         string& operator=(const string& rhs);
 
         //dtor
@@ -22,13 +27,19 @@ namespace qh
         size_t size() const;
         const char* data() const;
         const char* c_str() const;
+        memory_resource* get_memory_resource() const;
 
         // set & get
         char* operator[](size_t index);
 
+    private:
+        void assign(const char* s, size_t len);
+        void release();
+
     private:
         char*  data_;
         size_t len_;
+        memory_resource* resource_;
     };
 }
 
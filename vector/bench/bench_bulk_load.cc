@@ -0,0 +1,97 @@
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "qh_bench.h"
+#include "qh_vector.h"
+
+namespace
+{
+    const size_t kElements = 1 << 20;
+    const size_t kRounds = 20;
+
+    template<class Vector, class T>
+    void PushBackLoop(const std::vector<T>& source)
+    {
+        for (size_t r = 0; r < kRounds; ++r)
+        {
+            Vector v;
+            for (size_t i = 0; i < source.size(); ++i)
+            {
+                v.push_back(source[i]);
+            }
+            qh::bench::DoNotOptimize(v[source.size() - 1]);
+        }
+    }
+
+    template<class Vector, class T>
+    void RangeInsert(const std::vector<T>& source)
+    {
+        for (size_t r = 0; r < kRounds; ++r)
+        {
+            Vector v;
+            v.insert(v.end(), source.data(), source.data() + source.size());
+            qh::bench::DoNotOptimize(v[source.size() - 1]);
+        }
+    }
+
+    template<class Vector, class T>
+    void RangeAssign(const std::vector<T>& source)
+    {
+        Vector v;
+        for (size_t r = 0; r < kRounds; ++r)
+        {
+            v.assign(source.data(), source.data() + source.size());
+            qh::bench::DoNotOptimize(v[source.size() - 1]);
+        }
+    }
+
+    template<class Vector, class T>
+    void EraseFront(const std::vector<T>& source)
+    {
+        // drop the first 1/16th at a time until the vector is empty
+        for (size_t r = 0; r < kRounds; ++r)
+        {
+            Vector v;
+            v.assign(source.data(), source.data() + source.size());
+            size_t chunk = source.size() / 16;
+            while (v.size() >= chunk && chunk)
+            {
+                v.erase(v.begin(), v.begin() + chunk);
+            }
+            qh::bench::DoNotOptimize(v.size());
+        }
+    }
+
+    template<class T>
+    void Compare(const char* type_name, const std::vector<T>& source)
+    {
+        char name[96];
+        const uint64_t ops = source.size() * kRounds;
+#define QH_BENCH_COMPARE(op) \
+        snprintf(name, sizeof(name), #op "/std::vector<%s>", type_name); \
+        qh::bench::Run(name, ops, [&source]() { op<std::vector<T> >(source); }); \
+        snprintf(name, sizeof(name), #op "/qh::vector<%s>", type_name); \
+        qh::bench::Run(name, ops, [&source]() { op<qh::vector<T> >(source); })
+
+        QH_BENCH_COMPARE(PushBackLoop);
+        QH_BENCH_COMPARE(RangeInsert);
+        QH_BENCH_COMPARE(RangeAssign);
+        QH_BENCH_COMPARE(EraseFront);
+#undef QH_BENCH_COMPARE
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<int> ints(kElements);
+    for (size_t i = 0; i < ints.size(); ++i)
+    {
+        ints[i] = static_cast<int>(i);
+    }
+    Compare("int", ints);
+
+    std::vector<std::string> strings(kElements / 16, std::string("short"));
+    Compare("std::string", strings);
+    return 0;
+}
@@ -0,0 +1,72 @@
+#include <stdio.h>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "qh_bench.h"
+#include "qh_vector.h"
+#include "qh_concurrent_vector.h"
+
+namespace
+{
+    const size_t kTotal = 1 << 22;
+
+    struct Result
+    {
+        int  thread;
+        int  value;
+        long offset;
+    };
+
+    template<class Push>
+    void RunThreads(size_t threads, Push push)
+    {
+        std::vector<std::thread> workers;
+        size_t per_thread = kTotal / threads;
+        for (size_t t = 0; t < threads; ++t)
+        {
+            workers.push_back(std::thread([t, per_thread, &push]() {
+                for (size_t i = 0; i < per_thread; ++i)
+                {
+                    Result r = {static_cast<int>(t), static_cast<int>(i), static_cast<long>(i * 8)};
+                    push(r);
+                }
+            }));
+        }
+        for (size_t t = 0; t < workers.size(); ++t)
+        {
+            workers[t].join();
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t thread_counts[] = {1, 2, 4, 8, 16, 32, 64};
+    for (size_t i = 0; i < sizeof(thread_counts) / sizeof(thread_counts[0]); ++i)
+    {
+        size_t threads = thread_counts[i];
+        char name[64];
+
+        snprintf(name, sizeof(name), "push_back/mutex+qh::vector/%zu threads", threads);
+        qh::bench::Run(name, kTotal, [threads]() {
+            std::mutex mu;
+            qh::vector<Result> v;
+            RunThreads(threads, [&mu, &v](const Result& r) {
+                std::lock_guard<std::mutex> guard(mu);
+                v.push_back(r);
+            });
+            qh::bench::DoNotOptimize(v.size());
+        });
+
+        snprintf(name, sizeof(name), "push_back/qh::concurrent_vector/%zu threads", threads);
+        qh::bench::Run(name, kTotal, [threads]() {
+            qh::concurrent_vector<Result> v;
+            RunThreads(threads, [&v](const Result& r) {
+                v.push_back(r);
+            });
+            qh::bench::DoNotOptimize(v.size());
+        });
+    }
+    return 0;
+}
@@ -0,0 +1,53 @@
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "qh_bench.h"
+#include "qh_vector.h"
+
+namespace
+{
+    const size_t kElements = 1 << 20;
+    const size_t kRounds = 20;
+
+    struct Pod64
+    {
+        char bytes[64];
+    };
+
+    template<class Vector>
+    void PushBack(const typename Vector::value_type& value)
+    {
+        for (size_t r = 0; r < kRounds; ++r)
+        {
+            Vector v;
+            for (size_t i = 0; i < kElements; ++i)
+            {
+                v.push_back(value);
+            }
+            qh::bench::DoNotOptimize(v[kElements - 1]);
+        }
+    }
+
+    template<class T>
+    void Compare(const char* type_name, const T& value)
+    {
+        char name[64];
+        snprintf(name, sizeof(name), "push_back/std::vector<%s>", type_name);
+        qh::bench::Run(name, kElements * kRounds, [&value]() { PushBack<std::vector<T> >(value); });
+        snprintf(name, sizeof(name), "push_back/qh::vector<%s>", type_name);
+        qh::bench::Run(name, kElements * kRounds, [&value]() { PushBack<qh::vector<T> >(value); });
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Compare<int>("int", 42);
+    Compare<std::string>("std::string", std::string("short"));
+
+    Pod64 pod;
+    memset(&pod, 'p', sizeof(pod));
+    Compare<Pod64>("Pod64", pod);
+    return 0;
+}
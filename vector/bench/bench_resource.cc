@@ -0,0 +1,110 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+
+#include "qh_bench.h"
+#include "qh_vector.h"
+
+namespace
+{
+    const size_t kVectorsPerRequest = 4096;
+    const size_t kRequests = 200;
+    const size_t kMaxLength = 32;
+
+    size_t g_lengths[kVectorsPerRequest];
+
+    void InitInput()
+    {
+        unsigned int seed = 20140106;
+        for (size_t i = 0; i < kVectorsPerRequest; ++i)
+        {
+            seed = seed * 1103515245 + 12345;
+            g_lengths[i] = 1 + (seed >> 16) % kMaxLength;
+        }
+    }
+
+    // Build one request worth of short-lived vectors and destroy them all at the end,
+    // calling peak(mr) while they are still alive.
+    template<class Peak>
+    void OneRequest(qh::memory_resource* mr, Peak& peak)
+    {
+        typedef qh::vector<int> IntVector;
+        static char storage[kVectorsPerRequest * sizeof(IntVector)];
+        IntVector* vectors = reinterpret_cast<IntVector*>(storage);
+        for (size_t i = 0; i < kVectorsPerRequest; ++i)
+        {
+            new (vectors + i) IntVector(g_lengths[i], static_cast<int>(i), mr);
+        }
+        qh::bench::DoNotOptimize(vectors[kVectorsPerRequest - 1][0]);
+        peak(mr);
+        for (size_t i = 0; i < kVectorsPerRequest; ++i)
+        {
+            vectors[i].~IntVector();
+        }
+    }
+
+    void NoPeak(qh::memory_resource*) {}
+
+    struct ArenaPeak
+    {
+        size_t allocated, reserved;
+        ArenaPeak() : allocated(0), reserved(0) {}
+        void operator()(qh::memory_resource* mr)
+        {
+            qh::arena_resource* arena = static_cast<qh::arena_resource*>(mr);
+            allocated = arena->bytes_allocated();
+            reserved = arena->bytes_reserved();
+        }
+    };
+
+    struct PoolPeak
+    {
+        size_t requested, in_use, reserved;
+        PoolPeak() : requested(0), in_use(0), reserved(0) {}
+        void operator()(qh::memory_resource* mr)
+        {
+            qh::pool_resource* pool = static_cast<qh::pool_resource*>(mr);
+            requested = pool->bytes_requested();
+            in_use = pool->bytes_in_use();
+            reserved = pool->bytes_reserved();
+        }
+    };
+}
+
+int main(int argc, char* argv[])
+{
+    InitInput();
+    const uint64_t ops = kVectorsPerRequest * kRequests;
+
+    qh::bench::Run("vector/new_delete", ops, []() {
+        for (size_t r = 0; r < kRequests; ++r)
+        {
+            OneRequest(qh::new_delete_resource(), NoPeak);
+        }
+    });
+
+    ArenaPeak arena_peak;
+    qh::bench::Run("vector/arena", ops, [&arena_peak]() {
+        qh::arena_resource arena(64 * 1024);
+        for (size_t r = 0; r < kRequests; ++r)
+        {
+            OneRequest(&arena, arena_peak);
+            arena.release();
+        }
+    });
+    qh::bench::Report("vector/arena", "peak bytes allocated", arena_peak.allocated);
+    qh::bench::Report("vector/arena", "peak bytes reserved", arena_peak.reserved);
+
+    PoolPeak pool_peak;
+    qh::bench::Run("vector/pool", ops, [&pool_peak]() {
+        qh::pool_resource pool;
+        for (size_t r = 0; r < kRequests; ++r)
+        {
+            OneRequest(&pool, pool_peak);
+        }
+    });
+    qh::bench::Report("vector/pool", "peak bytes requested", pool_peak.requested);
+    qh::bench::Report("vector/pool", "peak bytes in use", pool_peak.in_use);
+    qh::bench::Report("vector/pool", "peak bytes reserved", pool_peak.reserved);
+    return 0;
+}
@@ -1,12 +1,813 @@
+#include <assert.h>
 #include <stdlib.h>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
 #include "qh_vector.h"
+#include "qh_small_vector.h"
+#include "qh_concurrent_vector.h"
 
+void test_ctor()
+{
+    qh::vector<int> empty;
+    assert(empty.size() == 0);
+    assert(empty.get_memory_resource() == qh::get_default_resource());
+
+    qh::vector<int> filled(5, 7);
+    assert(filled.size() == 5);
+    for (size_t i = 0; i < filled.size(); ++i)
+    {
+        assert(filled[i] == 7);
+    }
+
+    qh::vector<int> zero(0, 7);
+    assert(zero.size() == 0);
+
+    // a literal 0 is a count, not a NULL resource
+    qh::vector<int> none(0);
+    assert(none.size() == 0 && none.get_memory_resource() == qh::get_default_resource());
+    qh::vector<int> three(3);
+    assert(three.size() == 3 && three[2] == 0);
+    qh::small_vector<int, 4> small_none(0);
+    assert(small_none.empty() && small_none.is_small());
+}
+
+void test_copy_and_assign()
+{
+    qh::vector<int> a(3, 1);
+    a[1] = 2;
+    a[2] = 3;
+
+    qh::vector<int> b(a);
+    assert(b.size() == 3);
+    assert(b[0] == 1 && b[1] == 2 && b[2] == 3);
+    b[0] = 9;
+    assert(a[0] == 1);
+
+    qh::vector<int> c(10, 0);
+    c = a;
+    assert(c.size() == 3);
+    assert(c[2] == 3);
+
+    c = c;
+    assert(c.size() == 3);
+    assert(c[2] == 3);
+
+    qh::vector<int> empty;
+    c = empty;
+    assert(c.size() == 0);
+}
+
+void test_memory_resource()
+{
+    qh::arena_resource arena;
+    {
+        qh::vector<int> a(4, 1, &arena);
+        assert(a.get_memory_resource() == &arena);
+        assert(arena.bytes_allocated() == 4 * sizeof(int));
+
+        qh::vector<int> heap_copy(a);
+        assert(heap_copy.get_memory_resource() == qh::get_default_resource());
+        qh::vector<int> arena_copy(a, &arena);
+        assert(arena_copy.get_memory_resource() == &arena);
+        assert(arena.bytes_allocated() == 8 * sizeof(int));
+    }
+
+    qh::pool_resource pool;
+    {
+        qh::vector<double> a(3, 1.5, &pool);
+        assert(a[2] == 1.5);
+        assert(pool.bytes_requested() == 3 * sizeof(double));
+    }
+    assert(pool.bytes_in_use() == 0);
+}
+
+// Counts live instances so tests can check every construction is paired with a destruction
+struct Counted
+{
+    static int alive;
+    int value;
+
+    Counted(int v = 0) : value(v) { ++alive; }
+    Counted(const Counted& rhs) : value(rhs.value) { ++alive; }
+    Counted(Counted&& rhs) noexcept : value(rhs.value) { rhs.value = -1; ++alive; }
+    Counted& operator=(const Counted& rhs) { value = rhs.value; return *this; }
+    ~Counted() { --alive; }
+};
+int Counted::alive = 0;
+
+void test_push_back_and_growth()
+{
+    qh::vector<int> v;
+    assert(v.empty());
+    assert(v.capacity() == 0);
+
+    size_t reallocations = 0;
+    size_t last_capacity = 0;
+    for (int i = 0; i < 1000; ++i)
+    {
+        v.push_back(i);
+        if (v.capacity() != last_capacity)
+        {
+            assert(v.capacity() >= 2 * last_capacity);
+            last_capacity = v.capacity();
+            ++reallocations;
+        }
+    }
+    assert(v.size() == 1000);
+    assert(!v.empty());
+    assert(reallocations <= 11);
+    for (int i = 0; i < 1000; ++i)
+    {
+        assert(v[i] == i);
+    }
+    assert(v.front() == 0);
+    assert(v.back() == 999);
+
+    // pushing an element of the vector itself must survive the reallocation
+    qh::vector<std::string> s;
+    s.push_back("first element that does not fit in the small string buffer");
+    for (int i = 0; i < 10; ++i)
+    {
+        s.push_back(s[0]);
+    }
+    for (size_t i = 0; i < s.size(); ++i)
+    {
+        assert(s[i] == s[0]);
+    }
+}
+
+void test_pop_back_clear_resize_reserve()
+{
+    {
+        qh::vector<Counted> v;
+        for (int i = 0; i < 10; ++i)
+        {
+            v.push_back(Counted(i));
+        }
+        assert(Counted::alive == 10);
+        for (int i = 0; i < 10; ++i)
+        {
+            assert(v[i].value == i);
+        }
+
+        v.pop_back();
+        assert(v.size() == 9);
+        assert(Counted::alive == 9);
+
+        size_t cap = v.capacity();
+        v.clear();
+        assert(v.empty());
+        assert(v.capacity() == cap);
+        assert(Counted::alive == 0);
+
+        v.resize(5, Counted(3));
+        assert(v.size() == 5);
+        assert(v[4].value == 3);
+        assert(Counted::alive == 5);
+
+        v.resize(2);
+        assert(v.size() == 2);
+        assert(Counted::alive == 2);
+
+        v.resize(100, v[0]);
+        assert(v.size() == 100);
+        assert(v[99].value == 3);
+
+        v.reserve(1000);
+        assert(v.capacity() == 1000);
+        assert(v.size() == 100);
+        assert(v[50].value == 3);
+
+        v.reserve(10);
+        assert(v.capacity() == 1000);
+    }
+    assert(Counted::alive == 0);
+}
+
+void test_move_and_swap()
+{
+    qh::vector<std::string> a;
+    a.push_back("a");
+    a.push_back("b");
+    const std::string* p = a.data();
+
+    qh::vector<std::string> b(std::move(a));
+    assert(b.size() == 2);
+    assert(b.data() == p);
+    assert(a.size() == 0);
+    assert(a.data() == NULL);
+
+    qh::vector<std::string> c;
+    c = std::move(b);
+    assert(c.size() == 2);
+    assert(c[1] == "b");
+    assert(b.empty());
+
+    qh::arena_resource arena;
+    qh::vector<std::string> d(&arena);
+    d = std::move(c);
+    assert(d.get_memory_resource() == &arena);
+    assert(d.size() == 2);
+    assert(d[0] == "a");
+    assert(c.empty());
+
+    qh::vector<std::string> e(1, "e");
+    e.swap(c);
+    assert(e.empty());
+    assert(c.size() == 1 && c[0] == "e");
+
+    std::string joined;
+    for (qh::vector<std::string>::const_iterator it = d.begin(); it != d.end(); ++it)
+    {
+        joined += *it;
+    }
+    assert(joined == "ab");
+
+    // growing a vector of vectors moves the inner ones, their buffers stay put
+    static_assert(std::is_nothrow_move_constructible<qh::vector<int> >::value, "moves are noexcept");
+    static_assert(std::is_nothrow_move_assignable<qh::vector<int> >::value, "moves are noexcept");
+    qh::vector<qh::vector<int> > nested;
+    nested.push_back(qh::vector<int>(3, 1));
+    const int* inner = nested[0].data();
+    for (int i = 0; i < 100; ++i)
+    {
+        nested.push_back(qh::vector<int>(1, i));
+    }
+    assert(nested[0].data() == inner && nested[0].size() == 3);
+}
+
+void test_relocation()
+{
+    assert(qh::is_trivially_relocatable<int>::value);
+    assert(!qh::is_trivially_relocatable<std::string>::value);
+
+    // non-trivial elements are moved, not copied, when the buffer grows
+    qh::vector<Counted> v;
+    v.push_back(Counted(1));
+    v.reserve(64);
+    assert(v[0].value == 1);
+    assert(Counted::alive == 1);
+}
+
+// Copy-only, and the copy that makes throw_after reach 0 throws
+struct ThrowingCopy
+{
+    static int alive;
+    static int throw_after;
+    int value;
+
+    explicit ThrowingCopy(int v = 0) : value(v) { ++alive; }
+    ThrowingCopy(const ThrowingCopy& rhs) : value(rhs.value)
+    {
+        if (throw_after > 0 && --throw_after == 0)
+        {
+            throw 42;
+        }
+        ++alive;
+    }
+    ThrowingCopy& operator=(const ThrowingCopy& rhs) { value = rhs.value; return *this; }
+    ~ThrowingCopy() { --alive; }
+};
+int ThrowingCopy::alive = 0;
+int ThrowingCopy::throw_after = 0;
+
+void test_strong_guarantee()
+{
+    assert(!qh::is_trivially_relocatable<ThrowingCopy>::value);
+    {
+        qh::vector<ThrowingCopy> v;
+        for (int i = 0; i < 4; ++i)
+        {
+            v.emplace_back(i);
+        }
+        assert(v.size() == v.capacity());
+
+        // growing copies the 4 elements, the 3rd copy throws
+        ThrowingCopy::throw_after = 3;
+        bool thrown = false;
+        try
+        {
+            v.emplace_back(4);
+        }
+        catch (int)
+        {
+            thrown = true;
+        }
+        assert(thrown && v.size() == 4 && ThrowingCopy::alive == 4);
+        for (int i = 0; i < 4; ++i)
+        {
+            assert(v[i].value == i);
+        }
+
+        ThrowingCopy::throw_after = 2;
+        thrown = false;
+        try
+        {
+            v.reserve(100);
+        }
+        catch (int)
+        {
+            thrown = true;
+        }
+        assert(thrown && v.size() == 4 && v.capacity() == 4 && ThrowingCopy::alive == 4);
+
+        // inserting in the middle moves nothing in place: the copy of the
+        // suffix throws and the vector is as before
+        v.reserve(16);
+        ThrowingCopy more[] = {ThrowingCopy(8), ThrowingCopy(9)};
+        ThrowingCopy::throw_after = 4;
+        thrown = false;
+        try
+        {
+            v.insert(v.begin() + 1, more, more + 2);
+        }
+        catch (int)
+        {
+            thrown = true;
+        }
+        assert(thrown && v.size() == 4 && ThrowingCopy::alive == 6);
+        for (int i = 0; i < 4; ++i)
+        {
+            assert(v[i].value == i);
+        }
+
+        ThrowingCopy::throw_after = 0;
+        v.insert(v.begin() + 1, more, more + 2);
+        assert(v.size() == 6 && v[1].value == 8 && v[2].value == 9 && v[3].value == 1);
+    }
+    assert(ThrowingCopy::alive == 0);
+
+    qh::vector<double> huge;
+    bool thrown = false;
+    try
+    {
+        huge.reserve(static_cast<size_t>(-1) / 4);
+    }
+    catch (const std::bad_alloc&)
+    {
+        thrown = true;
+    }
+    assert(thrown && huge.capacity() == 0);
+}
+
+void test_small_vector()
+{
+    qh::arena_resource arena;
+    {
+        qh::small_vector<Counted, 4> v(&arena);
+        assert(v.is_small());
+        assert(v.capacity() == 4);
+        for (int i = 0; i < 4; ++i)
+        {
+            v.push_back(Counted(i));
+        }
+        assert(v.is_small());
+        assert(arena.bytes_allocated() == 0);
+
+        v.push_back(Counted(4));
+        assert(!v.is_small());
+        assert(v.capacity() >= 5);
+        assert(arena.bytes_allocated() > 0);
+        for (int i = 0; i < 5; ++i)
+        {
+            assert(v[i].value == i);
+        }
+        assert(Counted::alive == 5);
+
+        // a small_vector works wherever a vector<T>& is expected
+        qh::vector<Counted>& base = v;
+        base.pop_back();
+        assert(v.size() == 4);
+    }
+    assert(Counted::alive == 0);
+
+    // copies and moves of an inline small_vector
+    {
+        qh::small_vector<std::string, 2> a;
+        a.push_back("x");
+        qh::small_vector<std::string, 2> b(a);
+        assert(b.is_small());
+        assert(b.size() == 1 && b[0] == "x");
+
+        qh::small_vector<std::string, 2> c(std::move(a));
+        assert(c.is_small());
+        assert(c.size() == 1 && c[0] == "x");
+        assert(a.empty());
+
+        // moving a small_vector into a plain vector has to move element-wise
+        qh::vector<std::string> plain(std::move(c));
+        assert(plain.size() == 1 && plain[0] == "x");
+        assert(c.empty() && c.is_small());
+    }
+
+    // moves of a spilled small_vector steal the heap buffer
+    {
+        qh::small_vector<std::string, 2> a;
+        a.push_back("1");
+        a.push_back("2");
+        a.push_back("3");
+        const std::string* heap = a.data();
+
+        qh::small_vector<std::string, 2> b(std::move(a));
+        assert(b.data() == heap);
+        assert(a.empty());
+        assert(a.is_small());
+        assert(a.capacity() == 2);
+
+        a.push_back("reuse");
+        assert(a.is_small());
+
+        qh::small_vector<std::string, 2> c;
+        c = b;
+        assert(c.size() == 3 && c[2] == "3");
+
+        c.swap(a);
+        assert(c.size() == 1 && c[0] == "reuse");
+        assert(a.size() == 3 && a[1] == "2");
+
+        qh::vector<std::string> plain(3, "p");
+        c.swap(plain);
+        assert(c.size() == 3 && c[0] == "p");
+        assert(plain.size() == 1 && plain[0] == "reuse");
+    }
+
+    // vectors of vectors are relocated bitwise
+    assert(qh::is_trivially_relocatable<qh::vector<std::string> >::value);
+    assert((!qh::is_trivially_relocatable<qh::small_vector<std::string, 2> >::value));
+    qh::vector<qh::vector<int> > nested;
+    for (int i = 0; i < 100; ++i)
+    {
+        nested.push_back(qh::vector<int>(i, i));
+    }
+    for (int i = 0; i < 100; ++i)
+    {
+        assert(nested[i].size() == static_cast<size_t>(i));
+        assert(i == 0 || nested[i].back() == i);
+    }
+}
+
+struct Point
+{
+    int x, y;
+    Point(int ax, int ay) : x(ax), y(ay) {}
+};
+
+void test_emplace_back()
+{
+    qh::vector<Point> points;
+    for (int i = 0; i < 10; ++i)
+    {
+        Point& p = points.emplace_back(i, -i);
+        assert(p.x == i && p.y == -i);
+    }
+    assert(points.size() == 10);
+    assert(points[9].y == -9);
+
+    qh::vector<std::string> s;
+    s.emplace_back(3, 'z');
+    assert(s[0] == "zzz");
+    s.emplace_back("abc", 2);
+    assert(s[1] == "ab");
+
+    // emplacing from one of our own elements across a reallocation
+    qh::vector<std::string> self;
+    self.emplace_back("a value long enough to live on the heap");
+    self.emplace_back(self[0]);
+    assert(self[1] == self[0]);
+}
+
+template<class T>
+void check_range(const qh::vector<T>& v, const T* expected, size_t n)
+{
+    assert(v.size() == n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        assert(v[i] == expected[i]);
+    }
+}
+
+void test_insert()
+{
+    const int values[] = {1, 2, 3, 4, 5};
+    qh::vector<int> v;
+    v.insert(v.end(), values, values + 5);
+    check_range(v, values, 5);
+
+    // in place, in the middle
+    v.reserve(100);
+    const int middle[] = {8, 9};
+    qh::vector<int>::iterator it = v.insert(v.begin() + 2, middle, middle + 2);
+    assert(it == v.begin() + 2);
+    const int expected1[] = {1, 2, 8, 9, 3, 4, 5};
+    check_range(v, expected1, 7);
+
+    // with a reallocation, at the front
+    qh::vector<int> w(2, 0);
+    w.insert(w.begin(), values, values + 5);
+    const int expected2[] = {1, 2, 3, 4, 5, 0, 0};
+    check_range(w, expected2, 7);
+
+    w.insert(w.end(), values, values);
+    assert(w.size() == 7);
+
+    w.insert(w.begin() + 1, w[6]);
+    const int expected3[] = {1, 0, 2, 3, 4, 5, 0, 0};
+    check_range(w, expected3, 8);
+
+    // non-trivial elements, from a non-pointer iterator
+    std::string names[] = {"a", "b", "c"};
+    qh::vector<std::string> s(2, "x");
+    s.reserve(10);
+    s.insert(s.begin() + 1, std::make_move_iterator(names), std::make_move_iterator(names + 3));
+    const std::string expected4[] = {"x", "a", "b", "c", "x"};
+    check_range(s, expected4, 5);
+
+    s.insert(s.begin(), expected4, expected4 + 5);
+    assert(s.size() == 10);
+    assert(s[4] == "x" && s[5] == "x" && s[9] == "x");
+
+    {
+        qh::vector<Counted> c(3, Counted(1));
+        Counted more[] = {Counted(2), Counted(3)};
+        c.insert(c.begin() + 1, more, more + 2);
+        assert(c.size() == 5);
+        assert(c[1].value == 2 && c[2].value == 3 && c[3].value == 1);
+        assert(Counted::alive == 7);
+    }
+    assert(Counted::alive == 0);
+}
+
+void test_assign()
+{
+    const int values[] = {5, 6, 7};
+    qh::vector<int> v(10, 1);
+    size_t cap = v.capacity();
+    v.assign(values, values + 3);
+    check_range(v, values, 3);
+    assert(v.capacity() == cap);
+
+    const int many[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+    v.assign(many, many + 12);
+    check_range(v, many, 12);
+    assert(v.capacity() == 12);
+
+    v.assign(static_cast<size_t>(4), 9);
+    assert(v.size() == 4 && v[3] == 9);
+
+    qh::vector<std::string> s;
+    std::string names[] = {"a", "b"};
+    s.assign(names, names + 2);
+    assert(s.size() == 2 && s[1] == "b");
+
+    // ranges inside the vector itself: a tail, a head and the whole
+    qh::vector<std::string> self;
+    const char* words[] = {"zero", "a string long enough for the heap", "two", "three"};
+    for (size_t i = 0; i < 4; ++i)
+    {
+        self.push_back(words[i]);
+    }
+    self.assign(self.begin() + 1, self.end());
+    assert(self.size() == 3 && self[0] == words[1] && self[2] == words[3]);
+    self.assign(self.begin(), self.begin() + 2);
+    assert(self.size() == 2 && self[0] == words[1] && self[1] == words[2]);
+    self.shrink_to_fit();
+    assert(self.capacity() == 2);
+    self.assign(self.begin(), self.end());
+    assert(self.size() == 2 && self[0] == words[1]);
+
+    qh::vector<int> ints(3, 7);
+    ints.shrink_to_fit();
+    ints.push_back(8);
+    ints.assign(ints.begin() + 1, ints.end());
+    const int expected[] = {7, 7, 8};
+    check_range(ints, expected, 3);
+
+    // trivially copyable elements within capacity: one memmove, also across the old size
+    ints.reserve(8);
+    const int* buffer = ints.data();
+    ints.assign(many, many + 6);
+    check_range(ints, many, 6);
+    ints.assign(ints.begin() + 2, ints.begin() + 5);
+    check_range(ints, many + 2, 3);
+    ints.assign(ints.begin(), ints.begin());
+    assert(ints.empty() && ints.data() == buffer && ints.capacity() == 8);
+}
+
+void test_erase()
+{
+    const int values[] = {0, 1, 2, 3, 4, 5, 6};
+    qh::vector<int> v;
+    v.assign(values, values + 7);
+
+    qh::vector<int>::iterator it = v.erase(v.begin() + 1, v.begin() + 3);
+    assert(*it == 3);
+    const int expected1[] = {0, 3, 4, 5, 6};
+    check_range(v, expected1, 5);
+
+    it = v.erase(v.end() - 1);
+    assert(it == v.end());
+    const int expected2[] = {0, 3, 4, 5};
+    check_range(v, expected2, 4);
+
+    v.erase(v.begin(), v.begin());
+    assert(v.size() == 4);
+    v.erase(v.begin(), v.end());
+    assert(v.empty());
+
+    {
+        qh::vector<std::string> s;
+        std::string names[] = {"a", "b", "c", "d"};
+        s.assign(names, names + 4);
+        s.erase(s.begin());
+        const std::string expected3[] = {"b", "c", "d"};
+        check_range(s, expected3, 3);
+
+        qh::vector<Counted> c(5, Counted(1));
+        c.erase(c.begin() + 1, c.begin() + 4);
+        assert(c.size() == 2);
+        assert(Counted::alive == 2);
+    }
+    assert(Counted::alive == 0);
+}
+
+void test_shrink_to_fit()
+{
+    qh::vector<int> v;
+    v.reserve(100);
+    v.push_back(1);
+    v.push_back(2);
+    v.shrink_to_fit();
+    assert(v.capacity() == 2);
+    assert(v[0] == 1 && v[1] == 2);
+
+    v.clear();
+    v.shrink_to_fit();
+    assert(v.capacity() == 0);
+    assert(v.data() == NULL);
+
+    qh::small_vector<std::string, 4> s;
+    for (int i = 0; i < 10; ++i)
+    {
+        s.push_back("s");
+    }
+    assert(!s.is_small());
+    s.erase(s.begin() + 3, s.end());
+    s.shrink_to_fit();
+    assert(s.is_small());
+    assert(s.capacity() == 4);
+    assert(s.size() == 3 && s[2] == "s");
+}
+
+void test_concurrent_vector()
+{
+    {
+        qh::concurrent_vector<int> v;
+        assert(v.empty());
+        for (int i = 0; i < 1000; ++i)
+        {
+            assert(v.push_back(i) == static_cast<size_t>(i));
+        }
+        assert(v.size() == 1000);
+        const int* first = &v[0];
+        for (int i = 1000; i < 5000; ++i)
+        {
+            v.push_back(i);
+        }
+        // elements never move
+        assert(first == &v[0]);
+        for (int i = 0; i < 5000; ++i)
+        {
+            assert(v[i] == i);
+        }
+
+        long long sum = 0;
+        v.for_each([&sum](int x) { sum += x; });
+        assert(sum == 4999LL * 5000 / 2);
+    }
+
+    {
+        // over-aligned elements, in segments from the heap and from a pool
+        struct alignas(64) Line
+        {
+            int value;
+            explicit Line(int v) : value(v) {}
+        };
+        qh::pool_resource pool;
+        qh::concurrent_vector<Line> heap;
+        qh::concurrent_vector<Line> pooled(&pool);
+        for (int i = 0; i < 200; ++i)
+        {
+            heap.emplace_back(i);
+            pooled.emplace_back(i);
+        }
+        for (size_t i = 0; i < heap.size(); ++i)
+        {
+            assert(reinterpret_cast<uintptr_t>(&heap[i]) % 64 == 0 && heap[i].value == static_cast<int>(i));
+            assert(reinterpret_cast<uintptr_t>(&pooled[i]) % 64 == 0 && pooled[i].value == static_cast<int>(i));
+        }
+    }
+
+    {
+        qh::concurrent_vector<Counted> c;
+        c.emplace_back(1);
+        c.push_back(Counted(2));
+        assert(c[1].value == 2);
+        assert(Counted::alive == 2);
+    }
+    assert(Counted::alive == 0);
+}
+
+// Writers append (thread, sequence) pairs while a reader keeps scanning the
+// published prefix. Every element must be fully constructed when the reader sees
+// it and every pair must end up in the vector exactly once.
+void test_concurrent_vector_stress()
+{
+    const int kWriters = 8;
+    const int kPerWriter = 20000;
+
+    struct Item
+    {
+        int thread;
+        int sequence;
+        int check;
+        Item(int t, int s) : thread(t), sequence(s), check(t * 31 + s) {}
+    };
+
+    qh::concurrent_vector<Item> v;
+    std::atomic<bool> done(false);
+    std::atomic<bool> reader_ok(true);
+
+    std::thread reader([&]() {
+        while (!done.load())
+        {
+            size_t n = v.size();
+            for (size_t i = 0; i < n; ++i)
+            {
+                const Item& item = v[i];
+                if (item.check != item.thread * 31 + item.sequence)
+                {
+                    reader_ok = false;
+                }
+            }
+        }
+    });
+
+    std::vector<std::thread> writers;
+    for (int t = 0; t < kWriters; ++t)
+    {
+        writers.push_back(std::thread([&v, t, kPerWriter]() {
+            for (int s = 0; s < kPerWriter; ++s)
+            {
+                v.emplace_back(t, s);
+            }
+        }));
+    }
+    for (size_t t = 0; t < writers.size(); ++t)
+    {
+        writers[t].join();
+    }
+    done = true;
+    reader.join();
+    assert(reader_ok);
+
+    assert(v.size() == static_cast<size_t>(kWriters * kPerWriter));
+    std::vector<int> next(kWriters, 0);
+    for (size_t i = 0; i < v.size(); ++i)
+    {
+        // each writer's items appear in the order it pushed them
+        assert(v[i].sequence == next[v[i].thread]);
+        ++next[v[i].thread];
+    }
+    for (int t = 0; t < kWriters; ++t)
+    {
+        assert(next[t] == kPerWriter);
+    }
+}
 
 int main(int argc, char* argv[])
 {
     //TODO ӵԪԣԽԽã·ԽȫԽ
     //TODO ԪдοINIParserǸĿҪдһprintfҪassertжжϡ
 
+    test_ctor();
+    test_copy_and_assign();
+    test_memory_resource();
+    test_push_back_and_growth();
+    test_pop_back_clear_resize_reserve();
+    test_move_and_swap();
+    test_relocation();
+    test_strong_guarantee();
+    test_small_vector();
+    test_emplace_back();
+    test_insert();
+    test_assign();
+    test_erase();
+    test_shrink_to_fit();
+    test_concurrent_vector();
+    test_concurrent_vector_stress();
+
     qh::vector<int> num_vect;
     num_vect.push_back(1);
 
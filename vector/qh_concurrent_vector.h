@@ -0,0 +1,243 @@
+#ifndef QIHOO_CONCURRENT_VECTOR_H_
+#define QIHOO_CONCURRENT_VECTOR_H_
+
+#include <stdlib.h>
+#include <assert.h>
+#include <new>
+#include <atomic>
+#include <utility>
+
+#include "qh_memory_resource.h"
+
+namespace qh
+{
+    /**
+    * An append-only vector for many writer threads.
+    *
+    * Elements live in segments that are never moved or freed before the container
+    * dies: segment k holds kFirstSegmentSize << k elements, so the segment table
+    * itself never grows and element addresses are stable.
+    *
+    * push_back() claims a slot with one atomic fetch_add, constructs the element
+    * there and marks the slot ready, all without a lock. size() is the length of
+    * the ready prefix, so readers may iterate [0, size()) while writers keep
+    * appending. A writer that finds the prefix at or below its own slot scans
+    * the ready flags that follow and moves the prefix over the whole run with
+    * one CAS, so writers seldom touch the shared counter. Nobody waits for a
+    * slower writer: a writer preempted before it marks its slot only holds
+    * back size(), and the writer of that slot catches the prefix up once it
+    * finishes.
+    *
+    * The memory resource has to be thread safe, the default one is. T's
+    * constructor must not throw: a claimed slot that is never published would
+    * stall every later writer.
+    */
+    template<class T>
+    class concurrent_vector
+    {
+    public:
+        typedef T value_type;
+
+        static const size_t kFirstSegmentBits = 5;
+        static const size_t kFirstSegmentSize = static_cast<size_t>(1) << kFirstSegmentBits;
+        static const size_t kMaxSegments = 64 - kFirstSegmentBits;
+
+        explicit concurrent_vector(memory_resource* mr = NULL)
+            : resource_(mr ? mr : get_default_resource()), claimed_(0), published_(0)
+        {
+            for (size_t i = 0; i < kMaxSegments; ++i)
+            {
+                segments_[i].store(NULL, std::memory_order_relaxed);
+            }
+        }
+
+        //! \brief Must not run concurrently with anything else
+        ~concurrent_vector()
+        {
+            size_t n = claimed_.load(std::memory_order_relaxed);
+            for (size_t i = 0; i < n; ++i)
+            {
+                slot(i)->~T();
+            }
+            for (size_t k = 0; k < kMaxSegments; ++k)
+            {
+                T* seg = segments_[k].load(std::memory_order_relaxed);
+                if (seg)
+                {
+                    resource_->deallocate(seg, segment_bytes(k), segment_alignment());
+                }
+            }
+        }
+
+        //! \brief Append a copy of value. Thread safe.
+        //! \return - size_t - the index of the new element
+        size_t push_back(const T& value)
+        {
+            return emplace_back(value);
+        }
+
+        size_t push_back(T&& value)
+        {
+            return emplace_back(std::move(value));
+        }
+
+        template<class... Args>
+        size_t emplace_back(Args&&... args)
+        {
+            size_t index = claimed_.fetch_add(1, std::memory_order_relaxed);
+            T* p = slot_for_write(index);
+            new (p) T(std::forward<Args>(args)...);
+            publish(index);
+            return index;
+        }
+
+        //! \brief Number of published elements. Every index below it may be read.
+        size_t size() const
+        {
+            return published_.load(std::memory_order_acquire);
+        }
+
+        bool empty() const
+        {
+            return size() == 0;
+        }
+
+        //! \param[in] - size_t index - must be below a value returned by size()
+        const T& operator[](size_t index) const
+        {
+            return *slot(index);
+        }
+
+        T& operator[](size_t index)
+        {
+            return *slot(index);
+        }
+
+        //! \brief Call fn on every element published when the call starts
+        template<class Fn>
+        void for_each(Fn fn) const
+        {
+            size_t n = size();
+            for (size_t i = 0; i < n; ++i)
+            {
+                fn(*slot(i));
+            }
+        }
+
+    private:
+        static size_t segment_size(size_t k)
+        {
+            return kFirstSegmentSize << k;
+        }
+
+        static size_t segment_alignment()
+        {
+            return alignof(T) > memory_resource::kMaxAlign ? alignof(T) : memory_resource::kMaxAlign;
+        }
+
+        //! \brief A segment holds its elements followed by one ready flag per element
+        static size_t segment_bytes(size_t k)
+        {
+            return segment_size(k) * (sizeof(T) + sizeof(std::atomic<unsigned char>));
+        }
+
+        static std::atomic<unsigned char>* ready_flags(T* seg, size_t k)
+        {
+            return reinterpret_cast<std::atomic<unsigned char>*>(seg + segment_size(k));
+        }
+
+        //! \brief Whether the element at index is constructed. Its segment may not exist yet.
+        bool is_ready(size_t index) const
+        {
+            size_t k = segment_of(index);
+            T* seg = segments_[k].load(std::memory_order_acquire);
+            return seg && ready_flags(seg, k)[index - segment_base(k)].load(std::memory_order_seq_cst);
+        }
+
+        //! \brief Segment k covers indexes [kFirstSegmentSize * (2^k - 1), kFirstSegmentSize * (2^(k+1) - 1))
+        static size_t segment_of(size_t index)
+        {
+            size_t biased = (index >> kFirstSegmentBits) + 1;
+            return 63 - __builtin_clzll(biased);
+        }
+
+        static size_t segment_base(size_t k)
+        {
+            return kFirstSegmentSize * ((static_cast<size_t>(1) << k) - 1);
+        }
+
+        T* slot(size_t index) const
+        {
+            size_t k = segment_of(index);
+            T* seg = segments_[k].load(std::memory_order_acquire);
+            assert(seg);
+            return seg + (index - segment_base(k));
+        }
+
+        T* slot_for_write(size_t index)
+        {
+            size_t k = segment_of(index);
+            assert(k < kMaxSegments);
+            T* seg = segments_[k].load(std::memory_order_acquire);
+            if (!seg)
+            {
+                T* fresh = static_cast<T*>(resource_->allocate(segment_bytes(k), segment_alignment()));
+                std::atomic<unsigned char>* flags = ready_flags(fresh, k);
+                for (size_t i = 0; i < segment_size(k); ++i)
+                {
+                    new (flags + i) std::atomic<unsigned char>(0);
+                }
+                if (segments_[k].compare_exchange_strong(seg, fresh, std::memory_order_acq_rel))
+                {
+                    seg = fresh;
+                }
+                else
+                {
+                    // another writer installed the segment first, seg now holds it
+                    resource_->deallocate(fresh, segment_bytes(k), segment_alignment());
+                }
+            }
+            return seg + (index - segment_base(k));
+        }
+
+        void publish(size_t index)
+        {
+            // seq_cst on the flag and on the prefix: either we see the slot the
+            // prefix is stuck on as ready, or its writer sees our flag set
+            size_t k = segment_of(index);
+            T* seg = segments_[k].load(std::memory_order_acquire);
+            ready_flags(seg, k)[index - segment_base(k)].store(1, std::memory_order_seq_cst);
+
+            // Past our slot: whoever moved the prefix over it saw our flag, and
+            // so every flag set before ours. Otherwise publish the ready run.
+            size_t prefix = published_.load(std::memory_order_seq_cst);
+            while (prefix <= index)
+            {
+                size_t end = prefix;
+                size_t claimed = claimed_.load(std::memory_order_seq_cst);
+                while (end < claimed && is_ready(end))
+                {
+                    ++end;
+                }
+                // on failure prefix is reloaded: someone else moved it, look again
+                if (end == prefix || published_.compare_exchange_strong(prefix, end, std::memory_order_seq_cst))
+                {
+                    return;
+                }
+            }
+        }
+
+    private:
+        memory_resource*    resource_;
+        std::atomic<T*>     segments_[kMaxSegments];
+        // writers hammer both counters, keep them on separate cache lines
+        alignas(64) std::atomic<size_t> claimed_;
+        alignas(64) std::atomic<size_t> published_;
+
+        concurrent_vector(const concurrent_vector&);
+        concurrent_vector& operator=(const concurrent_vector&);
+    };
+}
+
+#endif
+
@@ -0,0 +1,80 @@
+#ifndef QIHOO_SMALL_VECTOR_H_
+#define QIHOO_SMALL_VECTOR_H_
+
+#include <type_traits>
+
+#include "qh_vector.h"
+
+namespace qh
+{
+    /**
+    * A qh::vector that keeps up to N elements in an inline buffer and only goes to
+    * its memory resource when it grows beyond that. All the element handling is
+    * qh::vector's, so a small_vector can be passed wherever a vector<T>& is expected.
+    */
+    template<class T, size_t N>
+    class small_vector : public vector<T>
+    {
+        static_assert(N > 0, "use qh::vector for a small_vector without inline storage");
+
+    public:
+        explicit small_vector(memory_resource* mr = NULL)
+            : vector<T>(inline_buffer(), N, mr)
+        {
+        }
+
+        explicit small_vector(size_t n, const T& value = T(), memory_resource* mr = NULL)
+            : vector<T>(inline_buffer(), N, mr)
+        {
+            this->resize(n, value);
+        }
+
+        //! \brief Picks the size over the resource for a literal count
+        explicit small_vector(int n, const T& value = T(), memory_resource* mr = NULL)
+            : small_vector(static_cast<size_t>(n), value, mr)
+        {
+        }
+
+        small_vector(const small_vector& rhs)
+            : vector<T>(inline_buffer(), N, get_default_resource())
+        {
+            vector<T>::operator=(rhs);
+        }
+
+        small_vector(small_vector&& rhs)
+            : vector<T>(inline_buffer(), N, rhs.get_memory_resource())
+        {
+            vector<T>::operator=(std::move(rhs));
+        }
+
+        small_vector& operator=(const small_vector& rhs)
+        {
+            vector<T>::operator=(rhs);
+            return *this;
+        }
+
+        small_vector& operator=(small_vector&& rhs)
+        {
+            vector<T>::operator=(std::move(rhs));
+            return *this;
+        }
+
+        //! \brief Whether the elements still live in the inline buffer
+        bool is_small() const
+        {
+            return this->is_inline();
+        }
+
+    private:
+        T* inline_buffer()
+        {
+            return reinterpret_cast<T*>(&storage_);
+        }
+
+    private:
+        typename std::aligned_storage<sizeof(T) * N, alignof(T)>::type storage_;
+    };
+}
+
+#endif
+
@@ -1,39 +1,152 @@
 #ifndef QIHOO_VECTOR_H_
 #define QIHOO_VECTOR_H_
 
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <new>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <type_traits>
+
+#include "qh_memory_resource.h"
+
 namespace qh
 {
+    /**
+    * Whether a T can be moved to a new address with memcpy and the old bytes simply
+    * forgotten. True for trivially copyable types; specialize it for types such as
+    * a pointer-owning handle that are safe to relocate bitwise but not to copy.
+    */
+    template<class T>
+    struct is_trivially_relocatable
+        : std::integral_constant<bool, std::is_trivially_copyable<T>::value>
+    {
+    };
+
     template<class T>
     class vector {
     public:
+        typedef T        value_type;
+        typedef T*       iterator;
+        typedef const T* const_iterator;
+
         //ctor
-        vector()
-            : data_(NULL), size_(0)
+        //! \param[in] - memory_resource * mr - where the elements live, NULL means get_default_resource()
+        explicit vector(memory_resource* mr = NULL)
+            : data_(NULL), size_(0), capacity_(0), resource_(mr ? mr : get_default_resource())
+            , inline_(NULL), inline_capacity_(0)
+        {
+        }
+
+        explicit vector( size_t n, const T& value = T(), memory_resource* mr = NULL)
+            : data_(NULL), size_(0), capacity_(0), resource_(mr ? mr : get_default_resource())
+            , inline_(NULL), inline_capacity_(0)
         {
+            reserve(n);
+            try
+            {
+                fill_construct(n, value);
+            }
+            catch (...)
+            {
+                destroy();
+                throw;
+            }
         }
 
-        explicit vector( size_t n, const T& value = T())
+        //! \brief Picks the size over the resource for a literal count, vector<int>(0) included
+        explicit vector(int n, const T& value = T(), memory_resource* mr = NULL)
+            : vector(static_cast<size_t>(n), value, mr)
         {
-            data_ = new T[n];
-            for (size_t i = 0; i < n; i++)
+        }
+
+        vector(const vector<T>& rhs)
+            : data_(NULL), size_(0), capacity_(0), resource_(get_default_resource())
+            , inline_(NULL), inline_capacity_(0)
+        {
+            try
+            {
+                copy_from(rhs);
+            }
+            catch (...)
             {
-                data_[0] = value;
+                destroy();
+                throw;
             }
         }
 
+        vector(const vector<T>& rhs, memory_resource* mr)
+            : data_(NULL), size_(0), capacity_(0), resource_(mr ? mr : get_default_resource())
+            , inline_(NULL), inline_capacity_(0)
+        {
+            try
+            {
+                copy_from(rhs);
+            }
+            catch (...)
+            {
+                destroy();
+                throw;
+            }
+        }
+
+        //! \brief Steals rhs's heap buffer, rhs is left empty. A small_vector
+        //!   still in its inline buffer is moved element-wise instead, and an
+        //!   exception from that terminates, as from any noexcept function.
+        vector(vector<T>&& rhs) noexcept
+            : data_(NULL), size_(0), capacity_(0), resource_(rhs.resource_)
+            , inline_(NULL), inline_capacity_(0)
+        {
+            *this = std::move(rhs);
+        }
+
+        //! \brief Copies the elements, *this keeps its own memory resource
         vector<T>& operator=(const vector<T>& rhs)
         {
-            data_ = rhs.data_;
-            size_ = rhs.size_;
+            if (this != &rhs)
+            {
+                clear();
+                copy_from(rhs);
+            }
+            return *this;
         }
 
-        //dtor
-        ~vector()
+        //! \brief Steals rhs's heap buffer when both share a resource, otherwise moves
+        //!   element-wise. noexcept so that containers of vectors relocate them by
+        //!   moving, the element-wise path terminates if it throws.
+        vector<T>& operator=(vector<T>&& rhs) noexcept
         {
-            if (data_)
+            if (this == &rhs)
+            {
+                return *this;
+            }
+
+            if (!rhs.is_inline() && resource_->is_equal(*rhs.resource_))
             {
-                delete data_;
+                destroy();
+                data_ = rhs.data_;
+                size_ = rhs.size_;
+                capacity_ = rhs.capacity_;
+                rhs.reset_to_inline();
+                return *this;
             }
+
+            clear();
+            reserve(rhs.size_);
+            for (; size_ < rhs.size_; ++size_)
+            {
+                new (data_ + size_) T(std::move(rhs.data_[size_]));
+            }
+            rhs.clear();
+            return *this;
+        }
+
+        //dtor
+        ~vector()
+        {
+            destroy();
         }
 
         //get
@@ -42,23 +155,642 @@ namespace qh
             return size_;
         }
 
+        size_t capacity() const
+        {
+            return capacity_;
+        }
+
+        bool empty() const
+        {
+            return size_ == 0;
+        }
+
+        memory_resource* get_memory_resource() const
+        {
+            return resource_;
+        }
+
+        T* data() { return data_; }
+        const T* data() const { return data_; }
+
+        iterator begin() { return data_; }
+        iterator end() { return data_ + size_; }
+        const_iterator begin() const { return data_; }
+        const_iterator end() const { return data_ + size_; }
+
+        T& front() { assert(size_ > 0); return data_[0]; }
+        T& back() { assert(size_ > 0); return data_[size_ - 1]; }
+        const T& front() const { assert(size_ > 0); return data_[0]; }
+        const T& back() const { assert(size_ > 0); return data_[size_ - 1]; }
+
         // set & get
-        T& operator[](size_t index);
+        T& operator[](size_t index)
+        {
+            assert(index < size_);
+            return data_[index];
+        }
+
+        const T& operator[](size_t index) const
+        {
+            assert(index < size_);
+            return data_[index];
+        }
 
         // set
-        void push_back(const T& element);
-        void pop_back(const T& element);
-        void resize();
-        void reserve();
-        void clear();
-        void empty();
+        void push_back(const T& element)
+        {
+            emplace_back(element);
+        }
+
+        void push_back(T&& element)
+        {
+            emplace_back(std::move(element));
+        }
+
+        //! \brief Construct a new last element in place from args
+        template<class... Args>
+        T& emplace_back(Args&&... args)
+        {
+            if (size_ == capacity_)
+            {
+                // args may refer to one of our elements, so construct the new one
+                // in the new buffer before the old buffer is released
+                size_t n = next_capacity(size_ + 1);
+                T* buf = allocate(n);
+                try
+                {
+                    new (buf + size_) T(std::forward<Args>(args)...);
+                }
+                catch (...)
+                {
+                    deallocate(buf, n);
+                    throw;
+                }
+                try
+                {
+                    move_construct_range(data_, data_ + size_, buf);
+                }
+                catch (...)
+                {
+                    buf[size_].~T();
+                    deallocate(buf, n);
+                    throw;
+                }
+                release_and_adopt(buf, n);
+            }
+            else
+            {
+                new (data_ + size_) T(std::forward<Args>(args)...);
+            }
+            return data_[size_++];
+        }
+
+        //! \brief Insert [first, last) before pos, reallocating at most once.
+        //! The range must not point into this vector.
+        //! \return - iterator - the first inserted element
+        template<class ForwardIt>
+        iterator insert(const_iterator pos, ForwardIt first, ForwardIt last)
+        {
+            assert(pos >= begin() && pos <= end());
+            size_t index = pos - data_;
+            size_t n = std::distance(first, last);
+            if (n == 0)
+            {
+                return data_ + index;
+            }
+
+            // shifting in place can not be undone if a move throws half way,
+            // such elements go through a new buffer and the old one stays intact
+            if (size_ + n > capacity_ || !can_shift_in_place())
+            {
+                size_t cap = size_ + n > capacity_ ? next_capacity(size_ + n) : capacity_;
+                T* buf = allocate(cap);
+                size_t built = 0;   // 1: the new range, 2: and the prefix
+                try
+                {
+                    construct_range(buf + index, first, last);
+                    built = 1;
+                    move_construct_range(data_, data_ + index, buf);
+                    built = 2;
+                    move_construct_range(data_ + index, data_ + size_, buf + index + n);
+                }
+                catch (...)
+                {
+                    destroy_built(buf, built >= 2 ? index : 0, buf + index, built >= 1 ? n : 0);
+                    deallocate(buf, cap);
+                    throw;
+                }
+                release_and_adopt(buf, cap);
+                size_ += n;
+                return data_ + index;
+            }
+
+            open_gap(index, n);
+            try
+            {
+                construct_range(data_ + index, first, last);
+            }
+            catch (...)
+            {
+                close_gap(index, n);
+                throw;
+            }
+            size_ += n;
+            return data_ + index;
+        }
+
+        iterator insert(const_iterator pos, const T& value)
+        {
+            // value may live in our own buffer
+            T copy(value);
+            return insert(pos, std::make_move_iterator(&copy), std::make_move_iterator(&copy + 1));
+        }
+
+        //! \brief Replace the contents with [first, last), reallocating at most once.
+        //! The range may be a part of this vector.
+        template<class ForwardIt>
+        void assign(ForwardIt first, ForwardIt last)
+        {
+            size_t n = std::distance(first, last);
+            if (n > capacity_)
+            {
+                // the old elements go only once the new ones are built from them
+                T* buf = allocate(n);
+                try
+                {
+                    construct_range(buf, first, last);
+                }
+                catch (...)
+                {
+                    deallocate(buf, n);
+                    throw;
+                }
+                destroy();
+                data_ = buf;
+                size_ = n;
+                capacity_ = n;
+                return;
+            }
+
+            assign_in_place(first, last, n);
+        }
+
+        void assign(size_t n, const T& value)
+        {
+            T copy(value);
+            clear();
+            reserve(n);
+            fill_construct(n, copy);
+        }
+
+        //! \brief Remove [first, last)
+        //! \return - iterator - the element that followed the removed range
+        iterator erase(const_iterator first, const_iterator last)
+        {
+            assert(first >= begin() && first <= last && last <= end());
+            size_t index = first - data_;
+            size_t n = last - first;
+            if (n == 0)
+            {
+                return data_ + index;
+            }
+
+            if (is_trivially_relocatable<T>::value)
+            {
+                destroy_range(index, index + n);
+                memmove(static_cast<void*>(data_ + index), static_cast<const void*>(data_ + index + n),
+                    (size_ - index - n) * sizeof(T));
+            }
+            else
+            {
+                std::move(data_ + index + n, data_ + size_, data_ + index);
+                destroy_range(size_ - n, size_);
+            }
+            size_ -= n;
+            return data_ + index;
+        }
+
+        iterator erase(const_iterator pos)
+        {
+            return erase(pos, pos + 1);
+        }
+
+        //! \brief Give back unused capacity. A small_vector moves back inline when it fits.
+        void shrink_to_fit()
+        {
+            if (capacity_ == size_ || is_inline())
+            {
+                return;
+            }
+
+            if (size_ == 0)
+            {
+                deallocate(data_, capacity_);
+                reset_to_inline();
+                return;
+            }
+            if (size_ <= inline_capacity_)
+            {
+                T* old = data_;
+                size_t old_capacity = capacity_;
+                relocate(old, old + size_, inline_);
+                deallocate(old, old_capacity);
+                data_ = inline_;
+                capacity_ = inline_capacity_;
+                return;
+            }
+            adopt(allocate(size_), size_);
+        }
+
+        void pop_back()
+        {
+            assert(size_ > 0);
+            data_[--size_].~T();
+        }
+
+        //! \brief Grow or shrink to n elements, new elements are copies of value
+        void resize(size_t n, const T& value = T())
+        {
+            if (n <= size_)
+            {
+                destroy_range(n, size_);
+                size_ = n;
+                return;
+            }
+
+            if (n > capacity_)
+            {
+                // value may live in our own buffer
+                T copy(value);
+                reserve(n < 2 * capacity_ ? 2 * capacity_ : n);
+                fill_construct(n, copy);
+                return;
+            }
+            fill_construct(n, value);
+        }
+
+        //! \brief Make room for at least n elements without reallocating
+        void reserve(size_t n)
+        {
+            if (n <= capacity_)
+            {
+                return;
+            }
+            adopt(allocate(n), n);
+        }
+
+        //! \brief Destroy every element, the capacity is kept
+        void clear()
+        {
+            destroy_range(0, size_);
+            size_ = 0;
+        }
+
+        void swap(vector<T>& rhs)
+        {
+            assert(resource_->is_equal(*rhs.resource_));
+            if (is_inline() || rhs.is_inline())
+            {
+                vector<T> tmp(std::move(*this));
+                *this = std::move(rhs);
+                rhs = std::move(tmp);
+                return;
+            }
+            std::swap(data_, rhs.data_);
+            std::swap(size_, rhs.size_);
+            std::swap(capacity_, rhs.capacity_);
+            std::swap(resource_, rhs.resource_);
+        }
+
+    protected:
+        //! \brief Used by small_vector: start out with capacity elements of storage at inline_buffer
+        vector(T* inline_buffer, size_t capacity, memory_resource* mr)
+            : data_(inline_buffer), size_(0), capacity_(capacity), resource_(mr ? mr : get_default_resource())
+            , inline_(inline_buffer), inline_capacity_(capacity)
+        {
+        }
+
+        //! \brief Whether the elements live in the small_vector's inline buffer
+        bool is_inline() const
+        {
+            return data_ != NULL && data_ == inline_;
+        }
+
+    private:
+        size_t next_capacity(size_t needed) const
+        {
+            size_t cap = capacity_ ? 2 * capacity_ : 1;
+            return cap < needed ? needed : cap;
+        }
+
+        T* allocate(size_t n)
+        {
+            if (n > static_cast<size_t>(-1) / sizeof(T))
+            {
+                throw std::bad_alloc();
+            }
+            return static_cast<T*>(resource_->allocate(n * sizeof(T)));
+        }
+
+        void deallocate(T* p, size_t n)
+        {
+            if (p && p != inline_)
+            {
+                resource_->deallocate(p, n * sizeof(T));
+            }
+        }
+
+        //! \brief Relocate the current elements into buf, which holds room for n, and release the old buffer.
+        //! If that throws, buf is released and *this is unchanged.
+        void adopt(T* buf, size_t n)
+        {
+            try
+            {
+                move_construct_range(data_, data_ + size_, buf);
+            }
+            catch (...)
+            {
+                deallocate(buf, n);
+                throw;
+            }
+            release_and_adopt(buf, n);
+        }
+
+        //! \brief buf holds the elements now: end the old ones and switch to buf
+        void release_and_adopt(T* buf, size_t n)
+        {
+            end_lifetime(data_, data_ + size_);
+            deallocate(data_, capacity_);
+            data_ = buf;
+            capacity_ = n;
+        }
+
+        //! \brief Move [first, last) to uninitialized dest, copying if moving may throw.
+        //! If a constructor throws, what was built at dest is destroyed and the sources are intact.
+        static void move_construct_range(T* first, T* last, T* dest)
+        {
+            if (is_trivially_relocatable<T>::value)
+            {
+                if (first != last)
+                {
+                    memcpy(static_cast<void*>(dest), static_cast<const void*>(first), (last - first) * sizeof(T));
+                }
+                return;
+            }
+
+            T* cur = dest;
+            try
+            {
+                for (T* p = first; p != last; ++p, ++cur)
+                {
+                    new (cur) T(std::move_if_noexcept(*p));
+                }
+            }
+            catch (...)
+            {
+                for (; dest != cur; ++dest)
+                {
+                    dest->~T();
+                }
+                throw;
+            }
+        }
+
+        //! \brief End the sources of move_construct_range(), a no-op after a bitwise copy
+        static void end_lifetime(T* first, T* last)
+        {
+            if (!is_trivially_relocatable<T>::value)
+            {
+                for (; first != last; ++first)
+                {
+                    first->~T();
+                }
+            }
+        }
+
+        //! \brief Move [first, last) to uninitialized dest and end the lifetime of the source objects
+        static void relocate(T* first, T* last, T* dest)
+        {
+            move_construct_range(first, last, dest);
+            end_lifetime(first, last);
+        }
+
+        //! \brief Unwind a partly built buffer: prefix elements at buf, n at range
+        static void destroy_built(T* buf, size_t prefix, T* range, size_t n)
+        {
+            if (!std::is_trivially_destructible<T>::value)
+            {
+                for (size_t i = 0; i < prefix; ++i)
+                {
+                    buf[i].~T();
+                }
+                for (size_t i = 0; i < n; ++i)
+                {
+                    range[i].~T();
+                }
+            }
+        }
+
+        //! \brief Whether open_gap() and close_gap() can not throw
+        static bool can_shift_in_place()
+        {
+            return is_trivially_relocatable<T>::value || std::is_nothrow_move_constructible<T>::value;
+        }
+
+        //! \brief Copy [first, last) into uninitialized dest, memcpy for contiguous trivially copyable data
+        template<class ForwardIt>
+        static void construct_range(T* dest, ForwardIt first, ForwardIt last)
+        {
+            T* cur = dest;
+            try
+            {
+                for (; first != last; ++first, ++cur)
+                {
+                    new (cur) T(*first);
+                }
+            }
+            catch (...)
+            {
+                for (; dest != cur; ++dest)
+                {
+                    dest->~T();
+                }
+                throw;
+            }
+        }
+
+        static void construct_range(T* dest, const T* first, const T* last)
+        {
+            if (std::is_trivially_copyable<T>::value)
+            {
+                if (first != last)
+                {
+                    memcpy(static_cast<void*>(dest), static_cast<const void*>(first), (last - first) * sizeof(T));
+                }
+                return;
+            }
+            construct_range<const T*>(dest, first, last);
+        }
+
+        static void construct_range(T* dest, T* first, T* last)
+        {
+            construct_range(dest, const_cast<const T*>(first), const_cast<const T*>(last));
+        }
+
+        //! \brief Replace the elements with the n of [first, last), n <= capacity_.
+        //! The range may overlap the elements.
+        template<class ForwardIt>
+        void assign_in_place(ForwardIt first, ForwardIt last, size_t n)
+        {
+            // front to back, every source is read before its slot is overwritten
+            size_t i = 0;
+            for (; i < size_ && first != last; ++i, ++first)
+            {
+                data_[i] = *first;
+            }
+            if (i < size_)
+            {
+                destroy_range(i, size_);
+                size_ = i;
+                return;
+            }
+            construct_range(data_ + size_, first, last);
+            size_ = n;
+        }
+
+        void assign_in_place(const T* first, const T* last, size_t n)
+        {
+            if (std::is_trivially_copyable<T>::value)
+            {
+                // nothing to destroy, and memmove copes with a range inside the vector
+                if (n)
+                {
+                    memmove(static_cast<void*>(data_), static_cast<const void*>(first), n * sizeof(T));
+                }
+                size_ = n;
+                return;
+            }
+            assign_in_place<const T*>(first, last, n);
+        }
+
+        void assign_in_place(T* first, T* last, size_t n)
+        {
+            assign_in_place(const_cast<const T*>(first), const_cast<const T*>(last), n);
+        }
+
+        //! \brief Relocate [index, size_) up by n, leaving n uninitialized slots at index.
+        //! Needs capacity_ >= size_ + n and can_shift_in_place().
+        void open_gap(size_t index, size_t n)
+        {
+            if (is_trivially_relocatable<T>::value)
+            {
+                memmove(static_cast<void*>(data_ + index + n), static_cast<const void*>(data_ + index),
+                    (size_ - index) * sizeof(T));
+                return;
+            }
+
+            for (size_t i = size_; i > index; --i)
+            {
+                new (data_ + i - 1 + n) T(std::move(data_[i - 1]));
+                data_[i - 1].~T();
+            }
+        }
+
+        //! \brief Undo open_gap()
+        void close_gap(size_t index, size_t n)
+        {
+            if (is_trivially_relocatable<T>::value)
+            {
+                memmove(static_cast<void*>(data_ + index), static_cast<const void*>(data_ + index + n),
+                    (size_ - index) * sizeof(T));
+                return;
+            }
+
+            for (size_t i = index; i < size_; ++i)
+            {
+                new (data_ + i) T(std::move(data_[i + n]));
+                data_[i + n].~T();
+            }
+        }
+
+        void fill_construct(size_t n, const T& value)
+        {
+            assert(n <= capacity_);
+            size_t first = size_;
+            try
+            {
+                for (; size_ < n; ++size_)
+                {
+                    new (data_ + size_) T(value);
+                }
+            }
+            catch (...)
+            {
+                destroy_range(first, size_);
+                size_ = first;
+                throw;
+            }
+        }
+
+        void copy_from(const vector<T>& rhs)
+        {
+            assert(size_ == 0);
+            reserve(rhs.size_);
+            try
+            {
+                for (; size_ < rhs.size_; ++size_)
+                {
+                    new (data_ + size_) T(rhs.data_[size_]);
+                }
+            }
+            catch (...)
+            {
+                clear();
+                throw;
+            }
+        }
+
+        void destroy_range(size_t first, size_t last)
+        {
+            if (!std::is_trivially_destructible<T>::value)
+            {
+                for (size_t i = first; i < last; ++i)
+                {
+                    data_[i].~T();
+                }
+            }
+        }
+
+        void destroy()
+        {
+            clear();
+            deallocate(data_, capacity_);
+            reset_to_inline();
+        }
+
+        void reset_to_inline()
+        {
+            data_ = inline_;
+            size_ = 0;
+            capacity_ = inline_capacity_;
+        }
 
     private:
         T*      data_;
         size_t  size_;
+        size_t  capacity_;
+        memory_resource* resource_;
+        T*      inline_;          //! small_vector's inline buffer, NULL for a plain vector
+        size_t  inline_capacity_;
+    };
+
+    //! A plain vector only points at its heap buffer, so it can be relocated bitwise.
+    //! small_vector cannot: its data_ may point into itself.
+    template<class T>
+    struct is_trivially_relocatable<vector<T> > : std::true_type
+    {
     };
 }
 
 #endif
 
-
@@ -0,0 +1,259 @@
+#include <ctype.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "qh_workload.h"
+
+namespace
+{
+    void Usage()
+    {
+        fprintf(stderr,
+            "usage: gen_workload urls [options]    one URL per line\n"
+            "       gen_workload ini [options]     an INI file\n"
+            "\n"
+            "common:  --seed N\n"
+            "urls:    --count N --hit-rate R --params MIN:MAX --value-len MIN:MAX\n"
+            "         --percent R --decoys R --nesting N --keys k1,k2,... --expected\n"
+            "ini:     --sections N --keys N --global N --depth N --key-len MIN:MAX\n"
+            "         --value-len MIN:MAX --line-sep S --kv-sep S --comments R\n"
+            "         --blanks R --padding R        (\\n \\r \\t are unescaped in S)\n");
+    }
+
+    //! \brief Only plain digits: strtoull would take "-5" as 2^64 - 5
+    bool ParseSize(const char* s, size_t* value)
+    {
+        if (!isdigit(static_cast<unsigned char>(*s)))
+        {
+            return false;
+        }
+        char* end = NULL;
+        errno = 0;
+        unsigned long long n = strtoull(s, &end, 10);
+        if (errno == ERANGE || *end != '\0' || n > static_cast<size_t>(-1))
+        {
+            return false;
+        }
+        *value = static_cast<size_t>(n);
+        return true;
+    }
+
+    bool ParseRate(const char* s, double* value)
+    {
+        char* end = NULL;
+        errno = 0;
+        *value = strtod(s, &end);
+        return end != s && *end == '\0' && errno != ERANGE && *value >= 0.0 && *value <= 1.0;
+    }
+
+    bool ParseRange(const char* s, size_t* lo, size_t* hi)
+    {
+        const char* colon = strchr(s, ':');
+        if (!colon)
+        {
+            return ParseSize(s, lo) && ParseSize(s, hi);
+        }
+        std::string first(s, colon);
+        return ParseSize(first.c_str(), lo) && ParseSize(colon + 1, hi) && *lo <= *hi;
+    }
+
+    std::string Unescape(const char* s)
+    {
+        std::string out;
+        for (; *s; ++s)
+        {
+            if (*s == '\\' && s[1])
+            {
+                ++s;
+                out.push_back(*s == 'n' ? '\n' : *s == 'r' ? '\r' : *s == 't' ? '\t' : *s);
+            }
+            else
+            {
+                out.push_back(*s);
+            }
+        }
+        return out;
+    }
+
+    std::vector<std::string> SplitKeys(const char* s)
+    {
+        std::vector<std::string> keys;
+        std::string key;
+        for (; ; ++s)
+        {
+            if (*s == ',' || *s == '\0')
+            {
+                if (!key.empty())
+                {
+                    keys.push_back(key);
+                }
+                key.clear();
+                if (*s == '\0')
+                {
+                    break;
+                }
+            }
+            else
+            {
+                key.push_back(*s);
+            }
+        }
+        return keys;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2 || (strcmp(argv[1], "urls") != 0 && strcmp(argv[1], "ini") != 0))
+    {
+        Usage();
+        return 2;
+    }
+    bool urls = strcmp(argv[1], "urls") == 0;
+
+    uint64_t seed = qh::kDefaultRandomSeed;
+    size_t count = 10000;
+    bool with_expected = false;
+    qh::workload::UrlOptions url_options;
+    qh::workload::IniOptions ini_options;
+
+    for (int i = 2; i < argc; ++i)
+    {
+        const char* flag = argv[i];
+        if (strcmp(flag, "--expected") == 0 && urls)
+        {
+            with_expected = true;
+            continue;
+        }
+        if (i + 1 == argc)
+        {
+            fprintf(stderr, "%s needs a value\n", flag);
+            Usage();
+            return 2;
+        }
+        const char* value = argv[++i];
+        size_t n = 0;
+        bool ok = true;
+        if (strcmp(flag, "--seed") == 0)
+        {
+            ok = ParseSize(value, &n);
+            seed = n;
+        }
+        else if (urls && strcmp(flag, "--count") == 0)
+        {
+            ok = ParseSize(value, &count);
+        }
+        else if (urls && strcmp(flag, "--hit-rate") == 0)
+        {
+            ok = ParseRate(value, &url_options.hit_rate);
+        }
+        else if (urls && strcmp(flag, "--params") == 0)
+        {
+            ok = ParseRange(value, &url_options.min_params, &url_options.max_params);
+        }
+        else if (urls && strcmp(flag, "--value-len") == 0)
+        {
+            ok = ParseRange(value, &url_options.min_value_len, &url_options.max_value_len);
+        }
+        else if (urls && strcmp(flag, "--percent") == 0)
+        {
+            ok = ParseRate(value, &url_options.percent_rate);
+        }
+        else if (urls && strcmp(flag, "--decoys") == 0)
+        {
+            ok = ParseRate(value, &url_options.decoy_rate);
+        }
+        else if (urls && strcmp(flag, "--nesting") == 0)
+        {
+            ok = ParseSize(value, &url_options.max_nesting);
+        }
+        else if (urls && strcmp(flag, "--keys") == 0)
+        {
+            url_options.keys = SplitKeys(value);
+            ok = !url_options.keys.empty();
+        }
+        else if (!urls && strcmp(flag, "--sections") == 0)
+        {
+            ok = ParseSize(value, &ini_options.sections);
+        }
+        else if (!urls && strcmp(flag, "--keys") == 0)
+        {
+            ok = ParseSize(value, &ini_options.keys_per_section);
+        }
+        else if (!urls && strcmp(flag, "--global") == 0)
+        {
+            ok = ParseSize(value, &ini_options.global_keys);
+        }
+        else if (!urls && strcmp(flag, "--depth") == 0)
+        {
+            ok = ParseSize(value, &ini_options.max_depth);
+        }
+        else if (!urls && strcmp(flag, "--key-len") == 0)
+        {
+            ok = ParseRange(value, &ini_options.min_key_len, &ini_options.max_key_len);
+        }
+        else if (!urls && strcmp(flag, "--value-len") == 0)
+        {
+            ok = ParseRange(value, &ini_options.min_value_len, &ini_options.max_value_len);
+        }
+        else if (!urls && strcmp(flag, "--line-sep") == 0)
+        {
+            ini_options.line_separator = Unescape(value);
+            ok = !ini_options.line_separator.empty();
+        }
+        else if (!urls && strcmp(flag, "--kv-sep") == 0)
+        {
+            ini_options.key_value_separator = Unescape(value);
+            ok = !ini_options.key_value_separator.empty();
+        }
+        else if (!urls && strcmp(flag, "--comments") == 0)
+        {
+            ok = ParseRate(value, &ini_options.comment_rate);
+        }
+        else if (!urls && strcmp(flag, "--blanks") == 0)
+        {
+            ok = ParseRate(value, &ini_options.blank_rate);
+        }
+        else if (!urls && strcmp(flag, "--padding") == 0)
+        {
+            ok = ParseRate(value, &ini_options.padding_rate);
+        }
+        else
+        {
+            fprintf(stderr, "unknown option %s\n", flag);
+            Usage();
+            return 2;
+        }
+        if (!ok)
+        {
+            fprintf(stderr, "bad value for %s: %s\n", flag, value);
+            return 2;
+        }
+    }
+
+    if (urls)
+    {
+        qh::workload::UrlGenerator generator(url_options, seed);
+        for (size_t i = 0; i < count; ++i)
+        {
+            qh::workload::UrlSample sample = generator.Next();
+            fwrite(sample.url.data(), 1, sample.url.size(), stdout);
+            if (with_expected)
+            {
+                putchar('\t');
+                fwrite(sample.expected.data(), 1, sample.expected.size(), stdout);
+            }
+            putchar('\n');
+        }
+    }
+    else
+    {
+        std::string ini = qh::workload::GenerateIni(ini_options, seed);
+        fwrite(ini.data(), 1, ini.size(), stdout);
+    }
+    return fflush(stdout) == 0 ? 0 : 1;
+}
@@ -0,0 +1,208 @@
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "qh_workload.h"
+
+namespace
+{
+    //! \brief Independent of proxy_url: the value of the first parameter
+    //!   named by a key that has a non-empty value
+    std::string ReferenceExtract(const std::vector<std::string>& keys, const std::string& url)
+    {
+        size_t p = url.find('?');
+        if (p == std::string::npos)
+        {
+            return "";
+        }
+        ++p;
+        while (p <= url.size())
+        {
+            size_t end = url.find('&', p);
+            if (end == std::string::npos)
+            {
+                end = url.size();
+            }
+            std::string param = url.substr(p, end - p);
+            size_t eq = param.find('=');
+            if (eq != std::string::npos && eq + 1 < param.size())
+            {
+                std::string name = param.substr(0, eq);
+                for (size_t i = 0; i < keys.size(); ++i)
+                {
+                    if (keys[i] == name)
+                    {
+                        return param.substr(eq + 1);
+                    }
+                }
+            }
+            p = end + 1;
+        }
+        return "";
+    }
+
+    size_t CountParams(const std::string& url)
+    {
+        size_t q = url.find('?');
+        if (q == std::string::npos)
+        {
+            return 0;
+        }
+        size_t n = 1;
+        for (size_t i = q; i < url.size(); ++i)
+        {
+            n += url[i] == '&';
+        }
+        return n;
+    }
+}
+
+void test_urls_deterministic()
+{
+    qh::workload::UrlOptions options;
+    std::vector<qh::workload::UrlSample> a = qh::workload::GenerateUrls(options, 1000, 1);
+    std::vector<qh::workload::UrlSample> b = qh::workload::GenerateUrls(options, 1000, 1);
+    std::vector<qh::workload::UrlSample> c = qh::workload::GenerateUrls(options, 1000, 2);
+    assert(a.size() == 1000);
+    size_t same_as_c = 0;
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        assert(a[i].url == b[i].url && a[i].expected == b[i].expected);
+        same_as_c += a[i].url == c[i].url;
+    }
+    assert(same_as_c == 0);
+
+    // streaming gives the same corpus
+    qh::workload::UrlGenerator generator(options, 1);
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        assert(generator.Next().url == a[i].url);
+    }
+}
+
+void test_urls_ground_truth()
+{
+    const double rates[] = {0.0, 0.3, 1.0};
+    for (size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); ++r)
+    {
+        qh::workload::UrlOptions options;
+        options.hit_rate = rates[r];
+        options.min_params = 2;
+        options.max_params = 40;
+        options.decoy_rate = 0.3;
+        options.max_nesting = 3;
+        std::vector<std::string> keys = qh::workload::DefaultKeys();
+
+        const size_t kCount = 20000;
+        std::vector<qh::workload::UrlSample> samples = qh::workload::GenerateUrls(options, kCount, 7);
+        size_t hits = 0;
+        for (size_t i = 0; i < samples.size(); ++i)
+        {
+            const qh::workload::UrlSample& s = samples[i];
+            assert(ReferenceExtract(keys, s.url) == s.expected);
+            size_t params = CountParams(s.url);
+            assert(params >= options.min_params && params <= options.max_params);
+            hits += !s.expected.empty();
+        }
+        double rate = static_cast<double>(hits) / kCount;
+        assert(rate >= rates[r] - 0.02 && rate <= rates[r] + 0.02);
+    }
+}
+
+void test_urls_options()
+{
+    qh::workload::UrlOptions options;
+    options.keys.push_back("target");
+    options.hit_rate = 1.0;
+    options.min_params = options.max_params = 5;
+    options.min_value_len = options.max_value_len = 100;
+    options.percent_rate = 0.5;
+    options.decoy_rate = 0.0;
+    options.max_nesting = 1;
+    std::vector<qh::workload::UrlSample> samples = qh::workload::GenerateUrls(options, 100, 3);
+    size_t percents = 0;
+    for (size_t i = 0; i < samples.size(); ++i)
+    {
+        assert(CountParams(samples[i].url) == 5);
+        assert(samples[i].url.find("target=") != std::string::npos);
+        assert(!samples[i].expected.empty());
+        percents += std::count(samples[i].url.begin(), samples[i].url.end(), '%');
+        // one level deep: the proxied URL carries no proxy key of its own
+        assert(samples[i].expected.find("target%3D") == std::string::npos);
+    }
+    // 4 values of 100 characters per URL, half of them encoded
+    assert(percents > 100 * 4 * 100 * 4 / 10);
+
+    options.max_nesting = 3;
+    samples = qh::workload::GenerateUrls(options, 100, 3);
+    size_t nested = 0;
+    for (size_t i = 0; i < samples.size(); ++i)
+    {
+        nested += samples[i].expected.find("target%3D") != std::string::npos;
+    }
+    assert(nested > 30);
+}
+
+void test_ini()
+{
+    qh::workload::IniOptions options;
+    options.sections = 20;
+    options.keys_per_section = 50;
+    options.global_keys = 7;
+    options.max_depth = 4;
+    std::vector<qh::workload::IniEntry> entries;
+    std::string ini = qh::workload::GenerateIni(options, 11, &entries);
+    assert(entries.size() == 20 * 50 + 7);
+    assert(ini == qh::workload::GenerateIni(options, 11));
+    assert(ini != qh::workload::GenerateIni(options, 12));
+
+    size_t headers = 0;
+    size_t deep = 0;
+    size_t pos = 0;
+    while ((pos = ini.find("\n[", pos)) != std::string::npos)
+    {
+        size_t end = ini.find('\n', pos + 1);
+        std::string line = ini.substr(pos + 1, end - pos - 1);
+        assert(line[line.size() - 1] == ']');
+        ++headers;
+        deep += std::count(line.begin(), line.end(), '.') > 0;
+        pos = end;
+    }
+    assert(headers == 20);
+    assert(deep > 0);
+
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        assert(entries[i].section.empty() == (i < 7));
+        assert(!entries[i].key.empty());
+        assert(ini.find(entries[i].key) != std::string::npos);
+        const std::string& v = entries[i].value;
+        assert(v.empty() || (v[0] != ' ' && v[v.size() - 1] != ' '));
+    }
+
+    options.line_separator = "\r\n";
+    options.key_value_separator = "::";
+    options.global_keys = 0;
+    entries.clear();
+    ini = qh::workload::GenerateIni(options, 11, &entries);
+    assert(entries.size() == 20 * 50);
+    assert(ini.find("\r\n") != std::string::npos);
+    assert(ini.find(entries[0].key) != std::string::npos);
+    for (size_t i = 0; i < ini.size(); ++i)
+    {
+        assert(ini[i] != '\n' || (i > 0 && ini[i - 1] == '\r'));
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    test_urls_deterministic();
+    test_urls_ground_truth();
+    test_urls_options();
+    test_ini();
+    printf("%s All test OK!\n", argv[0]);
+    return 0;
+}